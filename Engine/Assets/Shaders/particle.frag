@@ -2,6 +2,7 @@
 
 // Input from vertex shader
 layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in int fragQuad;  // 0 = world, 1 = minimap
 
 // Output color
 layout(location = 0) out vec4 outColor;
@@ -13,15 +14,59 @@ layout(binding = 0) uniform UniformBufferObject {
     vec2 resolution;  // Screen resolution
     vec2 worldOffset; // World camera position (x, y)
     float zoomLevel;  // Camera zoom level
+    ivec2 pageTableOrigin; // First chunk of the page table window
+    ivec2 lightMapOrigin;  // Chunk at light map texel (0, 0)
+    vec4 minimapRect;      // Minimap quad in pixels: x, y, width, height
+    ivec2 minimapOrigin;   // First chunk of the minimap window
+    int fogEnabled;        // Nonzero to darken cells out of sight
 } ubo;
 
-// Sampler for the world texture
-layout(binding = 1) uniform sampler2D worldTexture;
+// World atlas: one 64x64 page of material IDs per visible chunk
+layout(binding = 1) uniform usampler2D worldAtlas;
 
-// Material info - used for custom rendering effects per material
-layout(push_constant) uniform PushConstants {
-    uint materialType; // Material type being rendered
-} material;
+// Page + 1 of each chunk in a window starting at ubo.pageTableOrigin (0 = none).
+// The window wraps around: chunk c is at texel c mod PAGE_TABLE_SIZE.
+layout(binding = 2) uniform usampler2D pageTable;
+
+// Light from emissive materials around the camera, one texel per 4x4 cells,
+// already blurred on the CPU; sampled with linear filtering
+layout(binding = 4) uniform sampler2D lightMap;
+
+// Most common material of each 8x8 cell tile in a wide window starting at
+// chunk ubo.minimapOrigin; wraps around like the page table
+layout(binding = 5) uniform usampler2D minimap;
+
+// Fog of war: one bit per visible cell, a chunk row in FOG_TEXELS_PER_ROW
+// texels (low bits first), for the chunks of the page table window; chunk c
+// is the block at c mod PAGE_TABLE_SIZE
+layout(binding = 6) uniform usampler2D fogMask;
+
+// Must match VulkanRenderer and LightMap
+const int PAGE_SIZE = 64;
+const int ATLAS_PAGES_PER_ROW = 32;
+const int PAGE_TABLE_SIZE = 64;
+const int ATLAS_MIP_LEVELS = 4;
+const int LIGHT_CELLS_PER_TEXEL = 4;
+const int LIGHT_MAP_SIZE = 512;
+const int MINIMAP_TEXELS_PER_CHUNK = 8;
+const int MINIMAP_SIZE = 512;
+const int FOG_TEXELS_PER_ROW = 2;
+
+// Brightness left to cells hidden by fog of war, as in SoftwareRenderer
+const float FOG_BRIGHTNESS = 0.3;
+
+// Warm tint of emitted light
+const vec3 LIGHT_COLOR = vec3(1.0, 0.6, 0.25);
+
+// Per-material rendering parameters, indexed by material ID
+struct PaletteEntry {
+    vec4 color;   // Base color and alpha
+    vec4 effects; // x = grain, y = liquid shimmer, z = glow, w = flicker
+};
+
+layout(binding = 3) uniform MaterialPalette {
+    PaletteEntry entries[256];
+} palette;
 
 // Function to add subtle noise to make materials look more natural
 float hash(vec2 p) {
@@ -63,63 +108,146 @@ vec3 addLiquidEffect(vec3 color, vec2 coord) {
     return mix(color, highlight, wave * 0.3);
 }
 
+// Light at a world position; nothing outside the light map window
+float sampleLight(vec2 worldPos) {
+    vec2 texel = (worldPos - vec2(ubo.lightMapOrigin * PAGE_SIZE)) / float(LIGHT_CELLS_PER_TEXEL);
+    if (any(lessThan(texel, vec2(0.0))) || any(greaterThanEqual(texel, vec2(LIGHT_MAP_SIZE)))) {
+        return 0.0;
+    }
+    return texture(lightMap, texel / float(LIGHT_MAP_SIZE)).r;
+}
+
+// Whether the viewer sees a cell of a chunk in the page table window
+bool isVisible(ivec2 chunk, ivec2 local) {
+    if (ubo.fogEnabled == 0) {
+        return true;
+    }
+    ivec2 block = chunk & (PAGE_TABLE_SIZE - 1);
+    ivec2 texel = ivec2(block.x * FOG_TEXELS_PER_ROW + (local.x >> 5), block.y * PAGE_SIZE + local.y);
+    return ((texelFetch(fogMask, texel, 0).r >> uint(local.x & 31)) & 1u) != 0u;
+}
+
+// Color of a minimap pixel: the tile's material, with a frame around the
+// map and an outline of the part of the world on screen
+vec4 minimapColor() {
+    vec2 pixel = gl_FragCoord.xy - ubo.minimapRect.xy;
+    vec2 fromEdge = min(pixel, ubo.minimapRect.zw - pixel);
+    if (min(fromEdge.x, fromEdge.y) < 1.0) {
+        return vec4(0.8, 0.8, 0.8, 1.0);
+    }
+    
+    vec2 local = pixel / ubo.minimapRect.zw * float(MINIMAP_SIZE);
+    const float cellsPerTexel = float(PAGE_SIZE / MINIMAP_TEXELS_PER_CHUNK);
+    vec2 worldPos = vec2(ubo.minimapOrigin * PAGE_SIZE) + local * cellsPerTexel;
+    
+    // One pixel wide at the minimap's scale
+    float cellsPerPixel = float(MINIMAP_SIZE) * cellsPerTexel / ubo.minimapRect.z;
+    vec2 outside = abs(worldPos - ubo.worldOffset) - ubo.resolution * 0.5 / ubo.zoomLevel;
+    float edge = max(outside.x, outside.y);
+    if (edge <= 0.0 && edge > -cellsPerPixel) {
+        return vec4(1.0, 1.0, 1.0, 0.9);
+    }
+    
+    ivec2 texel = clamp(ivec2(local), ivec2(0), ivec2(MINIMAP_SIZE - 1));
+    uint materialID = texelFetch(minimap, (ubo.minimapOrigin * MINIMAP_TEXELS_PER_CHUNK + texel) & (MINIMAP_SIZE - 1), 0).r;
+    if (materialID == 0u) {
+        return vec4(0.0, 0.0, 0.0, 0.6);
+    }
+    return vec4(palette.entries[materialID].color.rgb, 1.0);
+}
+
 void main() {
-    // Sample the texture
-    vec4 texColor = texture(worldTexture, fragTexCoord);
+    if (fragQuad == 1) {
+        outColor = minimapColor();
+        return;
+    }
+    
+    // World cell under this pixel; the camera sits at the screen center
+    vec2 worldPos = ubo.worldOffset + (floor(gl_FragCoord.xy) - floor(ubo.resolution * 0.5)) / ubo.zoomLevel;
+    ivec2 cell = ivec2(floor(worldPos));
+    ivec2 chunk = ivec2(floor(vec2(cell) / float(PAGE_SIZE)));
+    ivec2 local = cell - chunk * PAGE_SIZE;
     
-    // Debug - temporarily show all materials 
-    // without filtering by material type
-    if (texColor.a < 0.01) {
+    // Find the chunk's page; chunks without one aren't loaded
+    ivec2 windowCoord = chunk - ubo.pageTableOrigin;
+    if (any(lessThan(windowCoord, ivec2(0))) || any(greaterThanEqual(windowCoord, ivec2(PAGE_TABLE_SIZE)))) {
         discard;
     }
+    uint page = texelFetch(pageTable, chunk & (PAGE_TABLE_SIZE - 1), 0).r;
+    if (page == 0u) {
+        discard;
+    }
+    page -= 1u;
+    
+    // Zoomed out, a pixel covers several cells; read the mip level whose
+    // texels are about one pixel, so the view doesn't shimmer as it moves
+    int lod = clamp(int(floor(-log2(ubo.zoomLevel))), 0, ATLAS_MIP_LEVELS - 1);
+    
+    ivec2 pageOrigin = ivec2(int(page) % ATLAS_PAGES_PER_ROW, int(page) / ATLAS_PAGES_PER_ROW) * PAGE_SIZE;
+    uint materialID = texelFetch(worldAtlas, (pageOrigin + local) >> lod, lod).r;
+    float light = sampleLight(worldPos);
     
-    // Extract material ID from red channel
-    uint textureMaterialID = uint(texColor.r * 255.0);
+    // Out of sight: dimmed flat color, no light or effects
+    if (!isVisible(chunk, local)) {
+        if (materialID == 0u) {
+            outColor = vec4(0.0, 0.0, 0.0, 1.0 - FOG_BRIGHTNESS);
+        } else {
+            outColor = vec4(palette.entries[materialID].color.rgb * FOG_BRIGHTNESS, 1.0);
+        }
+        return;
+    }
     
-    // Use this to debug in fragment shader
-    if (textureMaterialID == 0) {
-        discard; // Skip empty/air cells
+    // Material 0 is empty space
+    if (materialID == 0u) {
+        // Faint grid along chunk borders, one texel wide at any level
+        if ((local.x >> lod) == 0 || (local.y >> lod) == 0) {
+            outColor = vec4(vec3(50.0 / 255.0), 50.0 / 255.0);
+            return;
+        }
+        
+        // Glow in the air around emitters
+        if (light > 0.0) {
+            outColor = vec4(LIGHT_COLOR, light * 0.5);
+            return;
+        }
+        discard;
     }
     
-    // Get the material type from the push constant for material-specific effects
-    uint materialID = material.materialType;
+    PaletteEntry entry = palette.entries[materialID];
     
-    // Base case - use the material color from texture
-    vec3 finalColor = texColor.rgb;
-    float alpha = texColor.a;
+    vec3 finalColor = entry.color.rgb;
+    float alpha = entry.color.a;
     
     // Add noise-based detail to give texture to materials
-    vec2 noiseCoord = fragTexCoord * vec2(100.0, 100.0) + ubo.worldOffset;
+    vec2 noiseCoord = worldPos; // Anchored to the world so it scrolls with it
     float noiseValue = noise(noiseCoord);
     
-    // Apply material-specific effects
-    if (materialID == 1) { // Sand
-        // Add grainy texture to sand
-        finalColor *= 0.9 + 0.2 * noiseValue;
-    }
-    else if (materialID == 2) { // Water
-        // Add flowing/shimmering effect to water
+    // Grainy texture for solids
+    float grain = entry.effects.x;
+    finalColor *= 1.0 - grain + 2.0 * grain * noiseValue;
+    
+    // Flowing/shimmering effect for liquids
+    if (entry.effects.y > 0.0) {
         finalColor = addLiquidEffect(finalColor, fragTexCoord + vec2(0.0, ubo.time * 0.05));
-        // Make water slightly transparent
-        alpha = 0.8;
     }
-    else if (materialID == 4) { // Fire
-        // Add glowing/pulsating effect to fire
-        finalColor = addGlow(finalColor, 0.7);
-        
-        // Add flickering effect
-        float flicker = noise(vec2(ubo.time * 6.0, fragTexCoord.y * 10.0));
-        finalColor *= 0.8 + 0.4 * flicker;
-    }
-    else if (materialID == 10) { // Lava
-        // Add glowing effect to lava
-        finalColor = addGlow(finalColor, 0.4);
+    
+    // Glow for emissive materials: fast flicker for flames, slow pulse otherwise
+    if (entry.effects.z > 0.0) {
+        finalColor = addGlow(finalColor, entry.effects.z);
         
-        // Add slow pulsing
-        float pulse = 0.8 + 0.2 * sin(ubo.time * 0.5 + fragTexCoord.x * 5.0 + fragTexCoord.y * 3.0);
-        finalColor *= pulse;
+        float flickerStrength = entry.effects.w;
+        if (flickerStrength > 0.0) {
+            float flicker = noise(vec2(ubo.time * 6.0, fragTexCoord.y * 10.0));
+            finalColor *= 1.0 - 0.5 * flickerStrength + flickerStrength * flicker;
+        } else {
+            float pulse = 0.8 + 0.2 * sin(ubo.time * 0.5 + fragTexCoord.x * 5.0 + fragTexCoord.y * 3.0);
+            finalColor *= pulse;
+        }
     }
     
+    // Light from nearby emitters brightens and warms the surface
+    finalColor = finalColor * (1.0 + light) + LIGHT_COLOR * light * 0.25;
+    
     // Add subtle vignette effect for better appearance
     vec2 center = vec2(0.5, 0.5);
     float vignette = 1.0 - 0.3 * length(fragTexCoord - center);
@@ -6,6 +6,7 @@ layout(location = 1) in vec2 inTexCoord;
 
 // Output to fragment shader
 layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out int fragQuad;  // 0 = world, 1 = minimap
 
 // Uniform values that change each frame
 layout(binding = 0) uniform UniformBufferObject {
@@ -14,12 +15,25 @@ layout(binding = 0) uniform UniformBufferObject {
     vec2 resolution;  // Screen resolution
     vec2 worldOffset; // World camera position (x, y)
     float zoomLevel;  // Camera zoom level
+    ivec2 pageTableOrigin; // First chunk of the page table window
+    ivec2 lightMapOrigin;  // Chunk at light map texel (0, 0)
+    vec4 minimapRect;      // Minimap quad in pixels: x, y, width, height
+    ivec2 minimapOrigin;   // First chunk of the minimap window
+    int fogEnabled;        // Nonzero to darken cells out of sight
 } ubo;
 
 void main() {
     // Pass texture coordinates to fragment shader
     fragTexCoord = inTexCoord;
+    fragQuad = gl_InstanceIndex;
+    
+    // The world fills the screen; the minimap quad is moved into its rectangle
+    vec2 position = inPosition;
+    if (gl_InstanceIndex == 1) {
+        vec2 pixel = ubo.minimapRect.xy + (inPosition * 0.5 + 0.5) * ubo.minimapRect.zw;
+        position = pixel / ubo.resolution * 2.0 - 1.0;
+    }
     
     // Final vertex position
-    gl_Position = vec4(inPosition, 0.0, 1.0);
+    gl_Position = vec4(position, 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace Engine {
+
+// Weight of the newest frame in the smoothed statistics
+static const double SMOOTHING = 0.05;
+
+// Share of the gap to a cheaper frame the cost estimate closes per frame;
+// a costlier frame raises it at once
+static const double COST_DECAY = 0.02;
+
+// Slack left before the deadline, for frames a little over the estimate
+static const double SAFETY_MARGIN_MS = 1.0;
+
+// Sleeps can overshoot by about a scheduler tick, so the last part of the
+// wait yields in a loop instead
+static const double SPIN_THRESHOLD_MS = 1.5;
+
+static double ElapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static double Smooth(double average, double value) {
+    return average > 0.0 ? average + (value - average) * SMOOTHING : value;
+}
+
+FramePacer::FramePacer(double targetFrameMs)
+    : m_TargetFrameTime(targetFrameMs)
+    , m_CostEstimate(0.0)
+    , m_HasDeadline(false)
+    , m_InputAgeSum(0.0)
+    , m_InputCount(0)
+    , m_AverageInterval(0.0)
+    , m_AverageCost(0.0)
+    , m_AverageLatency(0.0) {
+    m_FrameStart = Clock::now();
+    m_LastPresent = m_FrameStart;
+}
+
+void FramePacer::SetTargetFrameTime(double targetFrameMs) {
+    m_TargetFrameTime = targetFrameMs;
+    m_HasDeadline = false;
+}
+
+void FramePacer::WaitForFrameStart() {
+    if (m_HasDeadline) {
+        const auto lead = std::chrono::duration<double, std::milli>(m_CostEstimate + SAFETY_MARGIN_MS);
+        const auto wake = m_Deadline - std::chrono::duration_cast<Clock::duration>(lead);
+        
+        const double remaining = ElapsedMs(Clock::now(), wake);
+        if (remaining > SPIN_THRESHOLD_MS) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remaining - SPIN_THRESHOLD_MS));
+        }
+        while (Clock::now() < wake) {
+            std::this_thread::yield();
+        }
+    }
+    
+    m_FrameStart = Clock::now();
+    m_InputAgeSum = 0.0;
+    m_InputCount = 0;
+}
+
+void FramePacer::AddInputEvent(double ageMs) {
+    m_InputAgeSum += std::max(0.0, ageMs);
+    m_InputCount++;
+}
+
+void FramePacer::EndFrame() {
+    const auto now = Clock::now();
+    const double cost = ElapsedMs(m_FrameStart, now);
+    
+    m_CostEstimate = cost > m_CostEstimate ? cost : m_CostEstimate + (cost - m_CostEstimate) * COST_DECAY;
+    m_AverageCost = Smooth(m_AverageCost, cost);
+    m_AverageInterval = Smooth(m_AverageInterval, ElapsedMs(m_LastPresent, now));
+    if (m_InputCount > 0) {
+        m_AverageLatency = Smooth(m_AverageLatency, m_InputAgeSum / m_InputCount + cost);
+    }
+    m_LastPresent = now;
+    
+    // A frame that missed its deadline, e.g. one held up by v-sync, starts a
+    // new schedule from its present, which then lines up with the display
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(m_TargetFrameTime));
+    if (!m_HasDeadline || now > m_Deadline) {
+        m_Deadline = now + period;
+        m_HasDeadline = true;
+    } else {
+        m_Deadline += period;
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+
+namespace Engine {
+
+// Paces the frame loop to a target frame time. Rather than sleeping off
+// whatever is left after present, it sleeps at the start of the frame,
+// before input is read, until just enough time is left for a frame of
+// recent cost. The frame then finishes right at its deadline with input
+// that is as fresh as it can be.
+class FramePacer {
+public:
+    explicit FramePacer(double targetFrameMs);
+    
+    void SetTargetFrameTime(double targetFrameMs);
+    double GetTargetFrameTime() const { return m_TargetFrameTime; }
+    
+    // Sleep until the frame has to start; call right before reading input
+    void WaitForFrameStart();
+    
+    // An input event read this frame, and how long it waited to be read (ms)
+    void AddInputEvent(double ageMs);
+    
+    // Call once the frame has been presented
+    void EndFrame();
+    
+    // Smoothed time between presents, time from reading input to present,
+    // and time from an input event arriving to the frame that used it being
+    // presented (ms). The display may add up to a refresh to the latter.
+    double GetFrameInterval() const { return m_AverageInterval; }
+    double GetFrameCost() const { return m_AverageCost; }
+    double GetInputLatency() const { return m_AverageLatency; }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    double m_TargetFrameTime;
+    double m_CostEstimate;      // Frame cost the schedule plans for: recent peaks, decaying
+    
+    Clock::time_point m_Deadline;     // When the current frame should be presented
+    Clock::time_point m_FrameStart;   // When the current frame read its input
+    Clock::time_point m_LastPresent;
+    bool m_HasDeadline;
+    
+    double m_InputAgeSum;       // Of the events read this frame
+    int m_InputCount;
+    
+    double m_AverageInterval;
+    double m_AverageCost;
+    double m_AverageLatency;
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace Engine {
+
+// Rounds an idle worker keeps looking for jobs before it goes to sleep
+static const int IDLE_SPINS = 64;
+
+// Worker identity of the current thread; -1 outside every pool
+static thread_local JobSystem* t_System = nullptr;
+static thread_local int t_WorkerIndex = -1;
+static thread_local uint32_t t_StealSeed = 0;
+
+// xorshift32; picks where a thread starts looking for jobs to steal
+static uint32_t NextRandom(uint32_t& state) {
+    if (state == 0) {
+        state = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+TaskGroup::TaskGroup(JobSystem& jobs)
+    : m_Jobs(jobs)
+    , m_Pending(0) {
+}
+
+TaskGroup::~TaskGroup() {
+    Wait();
+}
+
+void TaskGroup::Run(std::function<void()> task) {
+    if (m_Jobs.m_Workers.empty()) {
+        task();
+        return;
+    }
+    
+    m_Pending.fetch_add(1, std::memory_order_relaxed);
+    m_Jobs.Push(new JobSystem::Job{std::move(task), this}, false);
+}
+
+void TaskGroup::Wait() {
+    // Help with whatever the workers haven't taken yet
+    while (m_Pending.load(std::memory_order_acquire) > 0 && m_Jobs.RunGroupJob(this)) {
+    }
+    
+    // The rest are running; also makes sure the last Finish has let go
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Finished.wait(lock, [this]() { return m_Pending.load(std::memory_order_acquire) == 0; });
+}
+
+void TaskGroup::Finish() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        m_Finished.notify_all();
+    }
+}
+
+JobSystem::WorkQueue::WorkQueue()
+    : m_Top(0)
+    , m_Bottom(0)
+    , m_Jobs(new std::atomic<Job*>[CAPACITY]) {
+}
+
+bool JobSystem::WorkQueue::Push(Job* job) {
+    const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+    const int64_t top = m_Top.load(std::memory_order_acquire);
+    if (bottom - top >= CAPACITY)
+        return false;
+    
+    m_Jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JobSystem::Job* JobSystem::WorkQueue::Pop() {
+    const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    m_Bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_Top.load(std::memory_order_relaxed);
+    
+    if (top > bottom) {
+        // Empty
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    
+    Job* job = m_Jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // Last job; a thief may be taking it at the same time
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job* JobSystem::WorkQueue::Steal() {
+    int64_t top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+    
+    Job* job = m_Jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;   // Lost to the owner or another thief
+    return job;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+    : m_InjectedCount(0)
+    , m_BackgroundCount(0)
+    , m_QueuedJobs(0)
+    , m_SleepingWorkers(0)
+    , m_Stopping(false) {
+    // Every queue exists before any worker starts stealing
+    for (unsigned int i = 0; i < workerCount; i++) {
+        m_Queues.push_back(std::make_unique<WorkQueue>());
+    }
+    
+    m_Workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; i++) {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, static_cast<int>(i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_WakeCondition.notify_all();
+    
+    for (auto& worker : m_Workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+JobSystem& JobSystem::Get() {
+    static JobSystem instance;
+    return instance;
+}
+
+unsigned int JobSystem::DefaultWorkerCount() {
+    // Leave one hardware thread for the caller
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+std::future<void> JobSystem::Submit(std::function<void()> task) {
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = packaged->get_future();
+    
+    if (m_Workers.empty()) {
+        // No workers to hand it to, so run it right away
+        (*packaged)();
+        return result;
+    }
+    
+    Push(new Job{[packaged]() { (*packaged)(); }, nullptr}, true);
+    return result;
+}
+
+void JobSystem::ParallelFor(int begin, int end, const std::function<void(int)>& body, int grainSize,
+                            unsigned int maxThreads) {
+    if (end <= begin)
+        return;
+    
+    grainSize = std::max(1, grainSize);
+    const int blockCount = (end - begin + grainSize - 1) / grainSize;
+    
+    // Blocks are handed out from a shared counter; the group below keeps
+    // everything on this stack alive until the last helper is done
+    std::atomic<int> nextBlock(0);
+    auto runBlocks = [&nextBlock, begin, end, grainSize, blockCount, &body]() {
+        for (;;) {
+            const int block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+            if (block >= blockCount)
+                return;
+            
+            const int first = begin + block * grainSize;
+            const int last = std::min(end, first + grainSize);
+            for (int i = first; i < last; i++) {
+                body(i);
+            }
+        }
+    };
+    
+    // As many helpers as there are spare blocks; the caller takes blocks too
+    TaskGroup group(*this);
+    int helpers = std::min(static_cast<int>(m_Workers.size()), blockCount - 1);
+    if (maxThreads > 0) {
+        helpers = std::min(helpers, static_cast<int>(maxThreads) - 1);
+    }
+    for (int i = 0; i < helpers; i++) {
+        group.Run(runBlocks);
+    }
+    
+    runBlocks();
+    group.Wait();
+}
+
+void JobSystem::Push(Job* job, bool background) {
+    if (!background && t_System == this) {
+        if (!m_Queues[t_WorkerIndex]->Push(job)) {
+            // The deque is full; run the job here rather than queue without bound
+            RunJob(job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (background) {
+            m_Background.push_back(job);
+            m_BackgroundCount.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_Injected.push_back(job);
+            m_InjectedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    // Pairs with the sleeping count update in WorkerLoop: either the worker
+    // sees the job before it sleeps, or this sees the worker and wakes it
+    m_QueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+    if (m_SleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_WakeCondition.notify_one();
+    }
+}
+
+JobSystem::Job* JobSystem::FindJob() {
+    Job* job = nullptr;
+    
+    // Own deque first: the newest job is the one most likely still in cache
+    if (t_System == this) {
+        job = m_Queues[t_WorkerIndex]->Pop();
+    }
+    
+    if (!job && m_InjectedCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Injected.empty()) {
+            job = m_Injected.front();
+            m_Injected.pop_front();
+            m_InjectedCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    
+    // Then the oldest job of another worker, starting at a random one
+    const int queueCount = static_cast<int>(m_Queues.size());
+    if (!job && queueCount > 0) {
+        const int start = static_cast<int>(NextRandom(t_StealSeed) % queueCount);
+        for (int i = 0; i < queueCount && !job; i++) {
+            const int victim = (start + i) % queueCount;
+            if (t_System != this || victim != t_WorkerIndex) {
+                job = m_Queues[victim]->Steal();
+            }
+        }
+    }
+    
+    if (!job && m_BackgroundCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Background.empty()) {
+            job = m_Background.front();
+            m_Background.pop_front();
+            m_BackgroundCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    
+    if (job) {
+        m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+bool JobSystem::RunGroupJob(TaskGroup* group) {
+    Job* job = nullptr;
+    
+    if (t_System == this) {
+        // A worker's group jobs went onto its own deque; the newest job
+        // there is either one of them or older work of the same worker,
+        // which goes back where it was
+        WorkQueue& queue = *m_Queues[t_WorkerIndex];
+        job = queue.Pop();
+        if (job && job->group != group) {
+            queue.Push(job);
+            job = nullptr;
+        }
+    } else if (m_InjectedCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = std::find_if(m_Injected.begin(), m_Injected.end(), [group](const Job* queued) {
+            return queued->group == group;
+        });
+        if (it != m_Injected.end()) {
+            job = *it;
+            m_Injected.erase(it);
+            m_InjectedCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    
+    if (!job)
+        return false;
+    
+    m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    RunJob(job);
+    return true;
+}
+
+void JobSystem::RunJob(Job* job) {
+    job->task();
+    TaskGroup* group = job->group;
+    delete job;
+    if (group) {
+        group->Finish();
+    }
+}
+
+void JobSystem::WorkerLoop(int index) {
+    t_System = this;
+    t_WorkerIndex = index;
+    
+    for (;;) {
+        bool ranJob = false;
+        for (int spin = 0; spin < IDLE_SPINS && !ranJob; spin++) {
+            Job* job = FindJob();
+            ranJob = job != nullptr;
+            if (ranJob) {
+                RunJob(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (ranJob)
+            continue;
+        
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        m_WakeCondition.wait(lock, [this]() {
+            return m_Stopping || m_QueuedJobs.load(std::memory_order_seq_cst) > 0;
+        });
+        m_SleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        
+        if (m_Stopping && m_QueuedJobs.load(std::memory_order_relaxed) == 0)
+            return;
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
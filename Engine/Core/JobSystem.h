@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine {
+
+class JobSystem;
+
+// Jobs that are waited for together. Waiting runs the group's own jobs
+// that no worker has taken yet, then sleeps until the rest are done; it
+// never picks up jobs of other groups, so threads sharing a job system
+// don't end up running each other's work.
+class TaskGroup {
+public:
+    explicit TaskGroup(JobSystem& jobs);
+    ~TaskGroup();
+    
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    void Run(std::function<void()> task);
+    void Wait();
+    
+private:
+    friend class JobSystem;
+    
+    JobSystem& m_Jobs;
+    std::atomic<int> m_Pending;
+    
+    // The last job to finish wakes the waiter. Finishing holds the mutex,
+    // so the group can't be destroyed under a job that is still in Finish.
+    std::mutex m_Mutex;
+    std::condition_variable m_Finished;
+    
+    void Finish();
+};
+
+// Fixed set of worker threads with a Chase-Lev work-stealing deque each.
+// A worker pushes the jobs it spawns onto its own deque and takes them back
+// newest first; idle workers steal the oldest jobs from the others. Threads
+// outside the pool hand their jobs over through a shared queue and run the
+// ones of their own group while they wait for it.
+class JobSystem {
+public:
+    // Worker count excludes the calling thread, which helps out in ParallelFor
+    explicit JobSystem(unsigned int workerCount = DefaultWorkerCount());
+    ~JobSystem();
+    
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    // Engine-wide job system sized to the machine
+    static JobSystem& Get();
+    static unsigned int DefaultWorkerCount();
+    
+    // Queue a long-running background task; the future becomes ready once it
+    // has run. Only workers pick these up, never a thread waiting on a group.
+    std::future<void> Submit(std::function<void()> task);
+    
+    // Run body(i) for every i in [begin, end) and wait for all of them, on
+    // at most maxThreads threads counting the caller (0 = no limit)
+    void ParallelFor(int begin, int end, const std::function<void(int)>& body, int grainSize = 1,
+                     unsigned int maxThreads = 0);
+    
+    unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+    
+private:
+    friend class TaskGroup;
+    
+    struct Job {
+        std::function<void()> task;
+        TaskGroup* group;   // Group it belongs to, if any
+    };
+    
+    // Chase-Lev deque of fixed capacity. Only the owning worker pushes and
+    // pops at the bottom; any thread steals from the top.
+    class WorkQueue {
+    public:
+        static constexpr int64_t CAPACITY = 4096;
+        
+        WorkQueue();
+        
+        bool Push(Job* job);    // False when full
+        Job* Pop();
+        Job* Steal();
+    
+    private:
+        std::atomic<int64_t> m_Top;
+        std::atomic<int64_t> m_Bottom;
+        std::unique_ptr<std::atomic<Job*>[]> m_Jobs;
+    };
+    
+    std::vector<std::thread> m_Workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;   // One per worker
+    
+    // Jobs from threads outside the pool, and background tasks
+    std::mutex m_Mutex;
+    std::deque<Job*> m_Injected;
+    std::deque<Job*> m_Background;
+    std::atomic<int> m_InjectedCount;
+    std::atomic<int> m_BackgroundCount;
+    
+    // Idle workers sleep on m_WakeCondition while nothing is queued
+    std::condition_variable m_WakeCondition;
+    std::atomic<int> m_QueuedJobs;
+    std::atomic<int> m_SleepingWorkers;
+    bool m_Stopping;
+    
+    void Push(Job* job, bool background);
+    Job* FindJob();
+    bool RunGroupJob(TaskGroup* group);   // One not yet taken job of the group, if any
+    void RunJob(Job* job);
+    void WorkerLoop(int index);
+};
+
+} // namespace Engine
\ No newline at end of file
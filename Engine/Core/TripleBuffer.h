@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Engine {
+
+// Lock-free hand-off of whole values from one writer thread to one reader
+// thread. The writer fills its buffer and publishes it; the reader picks up
+// the newest published buffer whenever it likes. Neither side ever waits,
+// and values the reader was too slow to see are simply skipped.
+//
+// A buffer handed back to the writer still holds an older value, not an
+// empty one, so writers can update it in place.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : m_Middle(1), m_WriteIndex(0), m_ReadIndex(2) {}
+    
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+    
+    // Writer side: fill this buffer, then publish it
+    T& GetWriteBuffer() { return m_Buffers[m_WriteIndex]; }
+    
+    void Publish() {
+        // Swap the written buffer into the middle and take the old middle back
+        const uint8_t previous = m_Middle.exchange(m_WriteIndex | FRESH_BIT, std::memory_order_acq_rel);
+        m_WriteIndex = previous & INDEX_MASK;
+    }
+    
+    // Reader side: switch to the newest published buffer; returns false if
+    // nothing was published since the last call
+    bool Acquire() {
+        if (!(m_Middle.load(std::memory_order_relaxed) & FRESH_BIT))
+            return false;
+        
+        const uint8_t previous = m_Middle.exchange(m_ReadIndex, std::memory_order_acq_rel);
+        m_ReadIndex = previous & INDEX_MASK;
+        return true;
+    }
+    
+    const T& GetReadBuffer() const { return m_Buffers[m_ReadIndex]; }
+    
+private:
+    static constexpr uint8_t INDEX_MASK = 3;
+    static constexpr uint8_t FRESH_BIT = 4;  // Middle holds a buffer the reader hasn't taken
+    
+    T m_Buffers[3];
+    std::atomic<uint8_t> m_Middle;  // Index of the middle buffer, plus FRESH_BIT
+    uint8_t m_WriteIndex;           // Only touched by the writer
+    uint8_t m_ReadIndex;            // Only touched by the reader
+};
+
+} // namespace Engine
\ No newline at end of file
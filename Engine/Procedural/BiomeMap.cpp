@@ -0,0 +1,148 @@
+#include "BiomeMap.h"
+#include "Chunk.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+// Lattice steps per noise cell; 8 lattice samples = 128 cells per biome feature
+static const float BIOME_FREQUENCY = 1.0f / 8.0f;
+
+enum BiomeChannel : uint32_t {
+    CHANNEL_CAVES = 0,
+    CHANNEL_RELIEF = 1,
+    CHANNEL_SOIL = 2,
+    CHANNEL_MOISTURE = 3
+};
+
+static uint32_t Hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static float SmoothStep(float edge0, float edge1, float x) {
+    float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+static BiomeParams Lerp(const BiomeParams& a, const BiomeParams& b, float t) {
+    BiomeParams result;
+    result.groundLevel = a.groundLevel + (b.groundLevel - a.groundLevel) * t;
+    result.caveThreshold = a.caveThreshold + (b.caveThreshold - a.caveThreshold) * t;
+    result.caveWeight = a.caveWeight + (b.caveWeight - a.caveWeight) * t;
+    result.sandChance = a.sandChance + (b.sandChance - a.sandChance) * t;
+    result.waterChance = a.waterChance + (b.waterChance - a.waterChance) * t;
+    return result;
+}
+
+BiomeParams BiomeField::At(int localX, int localY) const {
+    const int spacing = BiomeMap::SAMPLE_SPACING;
+    
+    int cellX = std::clamp(localX / spacing, 0, latticeSize - 2);
+    int cellY = std::clamp(localY / spacing, 0, latticeSize - 2);
+    float tx = static_cast<float>(localX - cellX * spacing) / spacing;
+    float ty = static_cast<float>(localY - cellY * spacing) / spacing;
+    
+    const BiomeParams& topLeft = lattice[cellY * latticeSize + cellX];
+    const BiomeParams& topRight = lattice[cellY * latticeSize + cellX + 1];
+    const BiomeParams& bottomLeft = lattice[(cellY + 1) * latticeSize + cellX];
+    const BiomeParams& bottomRight = lattice[(cellY + 1) * latticeSize + cellX + 1];
+    
+    return Lerp(Lerp(topLeft, topRight, tx), Lerp(bottomLeft, bottomRight, tx), ty);
+}
+
+BiomeMap::BiomeMap(uint32_t seed)
+    : m_Seed(seed) {
+}
+
+BiomeField BiomeMap::EvaluateChunk(const glm::ivec2& chunkCoord) const {
+    BiomeField field;
+    field.latticeSize = Chunk::CHUNK_SIZE / SAMPLE_SPACING + 1;
+    field.lattice.resize(field.latticeSize * field.latticeSize);
+    
+    // Lattice points are shared with neighboring chunks, so edges line up
+    const int baseX = chunkCoord.x * (Chunk::CHUNK_SIZE / SAMPLE_SPACING);
+    const int baseY = chunkCoord.y * (Chunk::CHUNK_SIZE / SAMPLE_SPACING);
+    
+    BiomeParams sum{};
+    for (int y = 0; y < field.latticeSize; y++) {
+        for (int x = 0; x < field.latticeSize; x++) {
+            BiomeParams sample = Sample(baseX + x, baseY + y);
+            field.lattice[y * field.latticeSize + x] = sample;
+            
+            sum.groundLevel += sample.groundLevel;
+            sum.caveThreshold += sample.caveThreshold;
+            sum.caveWeight += sample.caveWeight;
+            sum.sandChance += sample.sandChance;
+            sum.waterChance += sample.waterChance;
+        }
+    }
+    
+    const float count = static_cast<float>(field.lattice.size());
+    field.average.groundLevel = sum.groundLevel / count;
+    field.average.caveThreshold = sum.caveThreshold / count;
+    field.average.caveWeight = sum.caveWeight / count;
+    field.average.sandChance = sum.sandChance / count;
+    field.average.waterChance = sum.waterChance / count;
+    
+    return field;
+}
+
+BiomeParams BiomeMap::Sample(int latticeX, int latticeY) const {
+    const float x = latticeX * BIOME_FREQUENCY;
+    const float y = latticeY * BIOME_FREQUENCY;
+    
+    float caves = ValueNoise(x, y, CHANNEL_CAVES);
+    float relief = ValueNoise(x, y, CHANNEL_RELIEF);
+    float soil = ValueNoise(x, y, CHANNEL_SOIL);
+    float moisture = ValueNoise(x, y, CHANNEL_MOISTURE);
+    
+    BiomeParams params;
+    params.caveWeight = SmoothStep(0.55f, 0.7f, caves);
+    params.groundLevel = Chunk::CHUNK_SIZE / 2 + (relief - 0.5f) * 24.0f;
+    params.caveThreshold = 0.25f + 0.15f * (1.0f - moisture); // Wetter regions have larger caverns
+    params.sandChance = 0.6f + 0.35f * soil;
+    params.waterChance = 0.01f + 0.08f * moisture;
+    return params;
+}
+
+float BiomeMap::LatticeValue(int x, int y, uint32_t channel) const {
+    uint32_t h = Hash(m_Seed ^ Hash(static_cast<uint32_t>(x) + Hash(static_cast<uint32_t>(y) + Hash(channel))));
+    return static_cast<float>(h) / 4294967295.0f;
+}
+
+float BiomeMap::ValueNoise(float x, float y, uint32_t channel) const {
+    // Two octaves of smoothly interpolated value noise
+    float total = 0.0f;
+    float amplitude = 1.0f;
+    float maxValue = 0.0f;
+    
+    for (int octave = 0; octave < 2; octave++) {
+        int ix = static_cast<int>(std::floor(x));
+        int iy = static_cast<int>(std::floor(y));
+        float fx = x - ix;
+        float fy = y - iy;
+        fx = fx * fx * (3.0f - 2.0f * fx);
+        fy = fy * fy * (3.0f - 2.0f * fy);
+        
+        uint32_t octaveChannel = channel * 16 + octave;
+        float top = LatticeValue(ix, iy, octaveChannel) +
+                    (LatticeValue(ix + 1, iy, octaveChannel) - LatticeValue(ix, iy, octaveChannel)) * fx;
+        float bottom = LatticeValue(ix, iy + 1, octaveChannel) +
+                       (LatticeValue(ix + 1, iy + 1, octaveChannel) - LatticeValue(ix, iy + 1, octaveChannel)) * fx;
+        
+        total += (top + (bottom - top) * fy) * amplitude;
+        maxValue += amplitude;
+        amplitude *= 0.5f;
+        x *= 2.0f;
+        y *= 2.0f;
+    }
+    
+    return total / maxValue;
+}
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+// Generation parameters that vary smoothly across the world
+struct BiomeParams {
+    float groundLevel;    // Terrain surface height, in cells from the top of the chunk
+    float caveThreshold;  // Noise value above which cave rock is solid
+    float caveWeight;     // 0 = surface terrain, 1 = cave region
+    float sandChance;     // Share of sand versus stone in loose material
+    float waterChance;    // Chance of water in open cave space
+};
+
+// Biome parameters for one chunk, blended bilinearly from the coarse lattice
+struct BiomeField {
+    int latticeSize = 0;               // Samples per edge (chunk edge / spacing + 1)
+    std::vector<BiomeParams> lattice;  // Row-major lattice samples
+    BiomeParams average{};             // Mean over the chunk's lattice samples
+    
+    BiomeParams At(int localX, int localY) const;
+};
+
+// Low-frequency biome layer evaluated on a lattice of one sample per
+// SAMPLE_SPACING cells, so a chunk costs a handful of noise samples
+// instead of one per cell.
+class BiomeMap {
+public:
+    static const int SAMPLE_SPACING = 16;
+    
+    BiomeMap(uint32_t seed = 12345);
+    
+    BiomeField EvaluateChunk(const glm::ivec2& chunkCoord) const;
+    
+    // Parameters at a lattice point (in lattice coordinates)
+    BiomeParams Sample(int latticeX, int latticeY) const;
+    
+private:
+    uint32_t m_Seed;
+    
+    float LatticeValue(int x, int y, uint32_t channel) const;
+    float ValueNoise(float x, float y, uint32_t channel) const;
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "CaveSmoothing.h"
+
+namespace Engine {
+
+void CaveBitboard::SetWall(int x, int y, bool wall) {
+    if (y < -1 || y > SIZE)
+        return;
+    
+    if (x == -1) {
+        leftHalo[y + 1] = wall;
+    } else if (x == SIZE) {
+        rightHalo[y + 1] = wall;
+    } else if (x >= 0 && x < SIZE) {
+        uint64_t bit = uint64_t(1) << x;
+        rows[y + 1] = wall ? (rows[y + 1] | bit) : (rows[y + 1] & ~bit);
+    }
+}
+
+bool CaveBitboard::IsWall(int x, int y) const {
+    if (y < -1 || y > SIZE)
+        return false;
+    
+    if (x == -1)
+        return leftHalo[y + 1];
+    if (x == SIZE)
+        return rightHalo[y + 1];
+    if (x < 0 || x >= SIZE)
+        return false;
+    
+    return (rows[y + 1] >> x) & 1;
+}
+
+void SmoothCaveBitboard(CaveBitboard& board, int iterations) {
+    const int ROW_COUNT = CaveBitboard::SIZE + 2;
+    
+    uint64_t west[ROW_COUNT];
+    uint64_t east[ROW_COUNT];
+    uint64_t next[ROW_COUNT];
+    
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        // Each cell's west and east neighbor, shifted into its own bit
+        for (int r = 0; r < ROW_COUNT; r++) {
+            west[r] = (board.rows[r] << 1) | uint64_t(board.leftHalo[r]);
+            east[r] = (board.rows[r] >> 1) | (uint64_t(board.rightHalo[r]) << 63);
+        }
+        
+        for (int r = 1; r < ROW_COUNT - 1; r++) {
+            const uint64_t center = board.rows[r];
+            
+            // Row above and below: three cells each, summed to 2 bits
+            uint64_t a = west[r - 1], b = board.rows[r - 1], c = east[r - 1];
+            const uint64_t aboveOnes = a ^ b ^ c;
+            const uint64_t aboveTwos = (a & b) | (c & (a ^ b));
+            
+            a = west[r + 1]; b = board.rows[r + 1]; c = east[r + 1];
+            const uint64_t belowOnes = a ^ b ^ c;
+            const uint64_t belowTwos = (a & b) | (c & (a ^ b));
+            
+            // Same row: the two side cells
+            const uint64_t sideOnes = west[r] ^ east[r];
+            const uint64_t sideTwos = west[r] & east[r];
+            
+            // Add up the ones; the carry joins the twos
+            const uint64_t ones = aboveOnes ^ belowOnes ^ sideOnes;
+            const uint64_t onesCarry = (aboveOnes & belowOnes) | (sideOnes & (aboveOnes ^ belowOnes));
+            
+            // Count of the four twos (0-4) as bits k0, k1, k2
+            const uint64_t partial = aboveTwos ^ belowTwos ^ sideTwos;
+            const uint64_t partialCarry = (aboveTwos & belowTwos) | (sideTwos & (aboveTwos ^ belowTwos));
+            const uint64_t k0 = partial ^ onesCarry;
+            const uint64_t k0Carry = partial & onesCarry;
+            const uint64_t k1 = partialCarry ^ k0Carry;
+            const uint64_t k2 = partialCarry & k0Carry;
+            
+            // Neighbors = ones + 2k: 5+ when k >= 3 or k == 2 with ones set,
+            // exactly 4 when k == 2 without (keeps existing walls)
+            next[r] = k2 | (k1 & (k0 | ones | center));
+        }
+        
+        for (int r = 1; r < ROW_COUNT - 1; r++) {
+            board.rows[r] = next[r];
+        }
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
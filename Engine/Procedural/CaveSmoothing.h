@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Engine {
+
+// Wall mask of a 64x64 chunk, one 64-bit word per row with bit x holding
+// column x, plus a one-cell halo taken from the neighboring chunks
+struct CaveBitboard {
+    static const int SIZE = 64;
+    
+    // Row y of the chunk is rows[y + 1]; rows[0] and rows[SIZE + 1] are halo
+    uint64_t rows[SIZE + 2] = {};
+    
+    // Halo columns -1 and SIZE, indexed like rows (so corners are included)
+    bool leftHalo[SIZE + 2] = {};
+    bool rightHalo[SIZE + 2] = {};
+    
+    void SetWall(int x, int y, bool wall);
+    bool IsWall(int x, int y) const;
+};
+
+// Runs the 4-5 cave rule on the interior rows: a cell becomes wall with 5 or
+// more wall neighbors and stays wall with 4. Neighbor counts are bit-sliced
+// across the whole row, so one iteration is a few dozen word operations per
+// row. The halo is held fixed.
+void SmoothCaveBitboard(CaveBitboard& board, int iterations);
+
+} // namespace Engine
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Chunk.h"
 #include "../Simulation/CellularAutomata.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -7,9 +8,23 @@ namespace Engine {
 
 // Initialize static member
 const int Chunk::CHUNK_SIZE = 64;
+const int Chunk::RENDER_TILE_SIZE = 8;
+
+// Seed for one update of one chunk (murmur3 finalizer over the inputs)
+static uint32_t UpdateSeed(const glm::ivec2& coord, uint32_t updateCount) {
+    uint32_t hash = static_cast<uint32_t>(coord.x) * 0x9E3779B1u;
+    hash ^= static_cast<uint32_t>(coord.y) * 0x85EBCA77u;
+    hash ^= updateCount * 0xC2B2AE3Du;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
+}
 
 Chunk::Chunk(const glm::ivec2& coord)
-    : m_ChunkCoord(coord), m_Updated(false) {
+    : m_ChunkCoord(coord), m_Updated(false), m_UpdateCount(0), m_RenderDirtyTiles(~uint64_t(0)) {
     // Initialize the grid with empty particles
     m_Grid.resize(CHUNK_SIZE * CHUNK_SIZE);
     
@@ -47,6 +62,36 @@ void Chunk::SetParticle(int x, int y, const Particle& particle) {
     MarkDirty(x, y);
 }
 
+void Chunk::BlitRow(int x, int y, const Particle* particles, int count) {
+    if (y < 0 || y >= CHUNK_SIZE)
+        return;
+    
+    // Clip the run to the chunk
+    if (x < 0) {
+        particles -= x;
+        count += x;
+        x = 0;
+    }
+    count = std::min(count, CHUNK_SIZE - x);
+    if (count <= 0)
+        return;
+    
+    std::copy(particles, particles + count, m_Grid.begin() + FlattenIndex(x, y));
+    
+    // The two ends span the run for the dirty rect, but every render tile
+    // in between changed too
+    MarkDirty(x, y);
+    MarkDirty(x + count - 1, y);
+    
+    const int tilesPerRow = CHUNK_SIZE / RENDER_TILE_SIZE;
+    const int rowStart = (y / RENDER_TILE_SIZE) * tilesPerRow;
+    uint64_t tiles = 0;
+    for (int tx = x / RENDER_TILE_SIZE; tx <= (x + count - 1) / RENDER_TILE_SIZE; tx++) {
+        tiles |= uint64_t(1) << (rowStart + tx);
+    }
+    m_RenderDirtyTiles.fetch_or(tiles, std::memory_order_relaxed);
+}
+
 bool Chunk::IsInBounds(int x, int y) const {
     return x >= 0 && x < CHUNK_SIZE && y >= 0 && y < CHUNK_SIZE;
 }
@@ -55,11 +100,20 @@ void Chunk::Update(float dt) {
     if (m_DirtyRect.IsEmpty())
         return; // No need to update if nothing has changed
     
+    // Take the dirty rect and start a fresh one, so cells changed during
+    // this update are picked up next tick instead of being cleared
+    Rect dirtyRect = m_DirtyRect;
+    ClearDirty();
+    
+    // Random numbers follow from the chunk and its update count alone, so
+    // the outcome is the same whichever thread runs it, in whatever order
+    CellularAutomata::SeedRandom(UpdateSeed(m_ChunkCoord, m_UpdateCount++));
+    
     // Use the dirty rect to optimize updates
-    int startX = m_DirtyRect.x;
-    int startY = m_DirtyRect.y;
-    int endX = startX + m_DirtyRect.width;
-    int endY = startY + m_DirtyRect.height;
+    int startX = dirtyRect.x;
+    int startY = dirtyRect.y;
+    int endX = startX + dirtyRect.width;
+    int endY = startY + dirtyRect.height;
     
     // Clamp to chunk bounds
     startX = std::max(0, startX);
@@ -73,9 +127,6 @@ void Chunk::Update(float dt) {
             CellularAutomata::UpdateParticle(*this, x, y, dt);
         }
     }
-    
-    // Clear the dirty rect for the next frame
-    ClearDirty();
 }
 
 void Chunk::Render() {
@@ -86,10 +137,22 @@ void Chunk::MarkDirty(int x, int y) {
     if (!IsInBounds(x, y))
         return;
     
+    // Only the cell itself looks different
+    const int tilesPerRow = CHUNK_SIZE / RENDER_TILE_SIZE;
+    const int tile = (y / RENDER_TILE_SIZE) * tilesPerRow + x / RENDER_TILE_SIZE;
+    m_RenderDirtyTiles.fetch_or(uint64_t(1) << tile, std::memory_order_relaxed);
+    
+    // Include the neighbors, since a change can free up the cells around it
+    int minX = std::max(0, x - 1);
+    int minY = std::max(0, y - 1);
+    int maxX = std::min(CHUNK_SIZE - 1, x + 1);
+    int maxY = std::min(CHUNK_SIZE - 1, y + 1);
+    
     if (m_DirtyRect.IsEmpty()) {
-        m_DirtyRect = Rect(x, y, 1, 1);
+        m_DirtyRect = Rect(minX, minY, maxX - minX + 1, maxY - minY + 1);
     } else {
-        m_DirtyRect.Expand(x, y);
+        m_DirtyRect.Expand(minX, minY);
+        m_DirtyRect.Expand(maxX, maxY);
     }
 }
 
@@ -143,9 +206,34 @@ bool Chunk::Load(const std::string& filename) {
     
     // Mark the entire chunk as dirty
     m_DirtyRect = Rect(0, 0, CHUNK_SIZE, CHUNK_SIZE);
+    m_RenderDirtyTiles.store(~uint64_t(0), std::memory_order_relaxed);
     
     file.close();
     return true;
 }
 
+uint64_t Chunk::ComputeHash() const {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    
+    // Same fields in the same order as Save
+    mix(&m_ChunkCoord.x, sizeof(int));
+    mix(&m_ChunkCoord.y, sizeof(int));
+    for (const auto& particle : m_Grid) {
+        mix(&particle.materialID, sizeof(uint8_t));
+        mix(&particle.velocityX, sizeof(float));
+        mix(&particle.velocityY, sizeof(float));
+        mix(&particle.lifetime, sizeof(uint32_t));
+        mix(&particle.flags, sizeof(uint32_t));
+    }
+    
+    return hash;
+}
+
 } // namespace Engine
\ No newline at end of file
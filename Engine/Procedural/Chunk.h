@@ -4,6 +4,9 @@
 #include "../Simulation/Particle.h"
 #include <vector>
 #include <memory>
+#include <string>
+#include <cstdint>
+#include <atomic>
 
 namespace Engine {
 
@@ -35,6 +38,7 @@ struct Rect {
 class Chunk {
 public:
     static const int CHUNK_SIZE; // Size of one dimension of the chunk
+    static const int RENDER_TILE_SIZE; // Side of a render tile; a chunk has 8x8 of them
     
     Chunk(const glm::ivec2& coord);
     ~Chunk();
@@ -43,6 +47,12 @@ public:
     const Particle& GetParticle(int x, int y) const;
     void SetParticle(int x, int y, const Particle& particle);
     
+    // Row y as CHUNK_SIZE contiguous particles, for bulk readers
+    const Particle* GetRow(int y) const { return &m_Grid[FlattenIndex(0, y)]; }
+    
+    // Copy count particles into row y starting at x (clipped to the chunk)
+    void BlitRow(int x, int y, const Particle* particles, int count);
+    
     bool IsInBounds(int x, int y) const;
     
     void Update(float dt);
@@ -53,16 +63,25 @@ public:
     bool IsDirty() const { return !m_DirtyRect.IsEmpty(); }
     const Rect& GetDirtyRect() const { return m_DirtyRect; }
     
+    // Render tiles changed since the snapshot publisher last took them, bit
+    // (ty * 8 + tx) per tile. Every tile starts out set.
+    uint64_t TakeRenderDirtyTiles() const { return m_RenderDirtyTiles.exchange(0, std::memory_order_relaxed); }
+    
     const glm::ivec2& GetCoord() const { return m_ChunkCoord; }
     
     void Save(const std::string& filename);
     bool Load(const std::string& filename);
     
+    // FNV-1a hash of the saved contents, for determinism checks
+    uint64_t ComputeHash() const;
+    
 private:
     glm::ivec2 m_ChunkCoord;          // Coordinates in world space
     std::vector<Particle> m_Grid;      // Flat array of particles
     Rect m_DirtyRect;                  // Bounding box of cells that changed
     bool m_Updated;                    // Flag to track if chunk was updated this frame
+    uint32_t m_UpdateCount;            // Updates run so far; seeds their random numbers
+    mutable std::atomic<uint64_t> m_RenderDirtyTiles; // Tiles the snapshot hasn't seen yet
     
     // Helper methods for converting between 2D and 1D indices
     int FlattenIndex(int x, int y) const { return y * CHUNK_SIZE + x; }
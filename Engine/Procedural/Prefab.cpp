@@ -0,0 +1,260 @@
+#include "Prefab.h"
+#include <fstream>
+#include <iostream>
+
+namespace Engine {
+
+static const char PREFAB_MAGIC[4] = { 'D', 'Y', 'G', 'P' };
+static const uint32_t PREFAB_VERSION = 1;
+static const uint8_t PREFAB_FLAG_RLE = 1;
+static const int MAX_PREFAB_SIZE = 4096;
+
+Prefab::Prefab()
+    : m_Width(0), m_Height(0) {
+}
+
+Prefab::Prefab(int width, int height)
+    : m_Width(width), m_Height(height) {
+    m_Cells.resize(width * height);
+    m_Mask.resize(width * height, 0);
+    m_RowSpans.resize(height);   // Nothing masked yet
+}
+
+void Prefab::SetCell(int x, int y, uint8_t materialID) {
+    if (x < 0 || x >= m_Width || y < 0 || y >= m_Height)
+        return;
+    
+    const bool wasMasked = m_Mask[FlattenIndex(x, y)] != 0;
+    m_Cells[FlattenIndex(x, y)] = Particle(materialID);
+    m_Mask[FlattenIndex(x, y)] = 1;
+    if (!wasMasked) {
+        BuildRowSpans(y);
+    }
+}
+
+void Prefab::ClearCell(int x, int y) {
+    if (x < 0 || x >= m_Width || y < 0 || y >= m_Height)
+        return;
+    
+    const bool wasMasked = m_Mask[FlattenIndex(x, y)] != 0;
+    m_Cells[FlattenIndex(x, y)] = Particle();
+    m_Mask[FlattenIndex(x, y)] = 0;
+    if (wasMasked) {
+        BuildRowSpans(y);
+    }
+}
+
+bool Prefab::IsMasked(int x, int y) const {
+    if (x < 0 || x >= m_Width || y < 0 || y >= m_Height)
+        return false;
+    
+    return m_Mask[FlattenIndex(x, y)] != 0;
+}
+
+uint8_t Prefab::GetMaterial(int x, int y) const {
+    if (x < 0 || x >= m_Width || y < 0 || y >= m_Height)
+        return 0;
+    
+    return m_Cells[FlattenIndex(x, y)].materialID;
+}
+
+const Prefab::Span* Prefab::GetRowSpans(int y, int& count) const {
+    if (y < 0 || y >= m_Height) {
+        count = 0;
+        return nullptr;
+    }
+    
+    count = static_cast<int>(m_RowSpans[y].size());
+    return m_RowSpans[y].data();
+}
+
+Prefab Prefab::Transformed(PrefabTransform transform) const {
+    const bool swapsAxes = transform == PrefabTransform::Rotate90 || transform == PrefabTransform::Rotate270;
+    Prefab result(swapsAxes ? m_Height : m_Width, swapsAxes ? m_Width : m_Height);
+    
+    for (int y = 0; y < m_Height; y++) {
+        for (int x = 0; x < m_Width; x++) {
+            int destX = x;
+            int destY = y;
+            
+            switch (transform) {
+                case PrefabTransform::None:
+                    break;
+                case PrefabTransform::FlipX:
+                    destX = m_Width - 1 - x;
+                    break;
+                case PrefabTransform::FlipY:
+                    destY = m_Height - 1 - y;
+                    break;
+                case PrefabTransform::Rotate90:
+                    destX = m_Height - 1 - y;
+                    destY = x;
+                    break;
+                case PrefabTransform::Rotate180:
+                    destX = m_Width - 1 - x;
+                    destY = m_Height - 1 - y;
+                    break;
+                case PrefabTransform::Rotate270:
+                    destX = y;
+                    destY = m_Width - 1 - x;
+                    break;
+            }
+            
+            int src = FlattenIndex(x, y);
+            int dest = result.FlattenIndex(destX, destY);
+            result.m_Cells[dest] = m_Cells[src];
+            result.m_Mask[dest] = m_Mask[src];
+        }
+    }
+    
+    result.BuildSpans();
+    return result;
+}
+
+void Prefab::BuildRowSpans(int y) {
+    std::vector<Span>& spans = m_RowSpans[y];
+    spans.clear();
+    
+    int x = 0;
+    while (x < m_Width) {
+        if (!m_Mask[FlattenIndex(x, y)]) {
+            x++;
+            continue;
+        }
+        
+        Span span;
+        span.start = x;
+        while (x < m_Width && m_Mask[FlattenIndex(x, y)]) {
+            x++;
+        }
+        span.length = x - span.start;
+        spans.push_back(span);
+    }
+}
+
+void Prefab::BuildSpans() {
+    m_RowSpans.resize(m_Height);
+    for (int y = 0; y < m_Height; y++) {
+        BuildRowSpans(y);
+    }
+}
+
+bool Prefab::Save(const std::string& filename, bool compress) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for saving prefab: " << filename << std::endl;
+        return false;
+    }
+    
+    uint8_t flags = compress ? PREFAB_FLAG_RLE : 0;
+    file.write(PREFAB_MAGIC, sizeof(PREFAB_MAGIC));
+    file.write(reinterpret_cast<const char*>(&PREFAB_VERSION), sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&m_Width), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&m_Height), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&flags), sizeof(uint8_t));
+    
+    const size_t cellCount = m_Cells.size();
+    
+    if (!compress) {
+        // Material plane, then mask plane
+        for (const auto& cell : m_Cells) {
+            file.write(reinterpret_cast<const char*>(&cell.materialID), sizeof(uint8_t));
+        }
+        file.write(reinterpret_cast<const char*>(m_Mask.data()), cellCount);
+        return file.good();
+    }
+    
+    // Runs of identical (mask, material) pairs in row-major order
+    size_t i = 0;
+    while (i < cellCount) {
+        uint8_t mask = m_Mask[i];
+        uint8_t material = m_Cells[i].materialID;
+        
+        uint16_t length = 1;
+        while (i + length < cellCount && length < UINT16_MAX &&
+               m_Mask[i + length] == mask && m_Cells[i + length].materialID == material) {
+            length++;
+        }
+        
+        file.write(reinterpret_cast<const char*>(&length), sizeof(uint16_t));
+        file.write(reinterpret_cast<const char*>(&mask), sizeof(uint8_t));
+        file.write(reinterpret_cast<const char*>(&material), sizeof(uint8_t));
+        i += length;
+    }
+    
+    return file.good();
+}
+
+bool Prefab::Load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for loading prefab: " << filename << std::endl;
+        return false;
+    }
+    
+    char magic[4];
+    uint32_t version = 0;
+    int width = 0;
+    int height = 0;
+    uint8_t flags = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(&width), sizeof(int));
+    file.read(reinterpret_cast<char*>(&height), sizeof(int));
+    file.read(reinterpret_cast<char*>(&flags), sizeof(uint8_t));
+    
+    if (!file || std::char_traits<char>::compare(magic, PREFAB_MAGIC, 4) != 0 || version != PREFAB_VERSION) {
+        std::cerr << "Not a prefab file: " << filename << std::endl;
+        return false;
+    }
+    
+    if (width <= 0 || height <= 0 || width > MAX_PREFAB_SIZE || height > MAX_PREFAB_SIZE) {
+        std::cerr << "Invalid prefab size " << width << "x" << height << ": " << filename << std::endl;
+        return false;
+    }
+    
+    Prefab loaded(width, height);
+    const size_t cellCount = loaded.m_Cells.size();
+    
+    if (flags & PREFAB_FLAG_RLE) {
+        size_t i = 0;
+        while (i < cellCount) {
+            uint16_t length = 0;
+            uint8_t mask = 0;
+            uint8_t material = 0;
+            file.read(reinterpret_cast<char*>(&length), sizeof(uint16_t));
+            file.read(reinterpret_cast<char*>(&mask), sizeof(uint8_t));
+            file.read(reinterpret_cast<char*>(&material), sizeof(uint8_t));
+            
+            if (!file || length == 0 || i + length > cellCount) {
+                std::cerr << "Corrupt prefab run data: " << filename << std::endl;
+                return false;
+            }
+            
+            for (size_t end = i + length; i < end; i++) {
+                loaded.m_Cells[i] = Particle(material);
+                loaded.m_Mask[i] = mask ? 1 : 0;
+            }
+        }
+    } else {
+        std::vector<uint8_t> materials(cellCount);
+        file.read(reinterpret_cast<char*>(materials.data()), cellCount);
+        file.read(reinterpret_cast<char*>(loaded.m_Mask.data()), cellCount);
+        
+        if (!file) {
+            std::cerr << "Truncated prefab file: " << filename << std::endl;
+            return false;
+        }
+        
+        for (size_t i = 0; i < cellCount; i++) {
+            loaded.m_Cells[i] = Particle(materials[i]);
+            loaded.m_Mask[i] = loaded.m_Mask[i] ? 1 : 0;
+        }
+    }
+    
+    loaded.BuildSpans();
+    *this = std::move(loaded);
+    return true;
+}
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../Simulation/Particle.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+enum class PrefabTransform {
+    None,
+    FlipX,
+    FlipY,
+    Rotate90,   // Clockwise
+    Rotate180,
+    Rotate270
+};
+
+// Authored template placed into the world with World::Stamp. Cells outside
+// the mask leave the world untouched; masked cells are written as-is, so a
+// masked empty cell carves out air.
+class Prefab {
+public:
+    // Run of masked cells within one row
+    struct Span {
+        int start;
+        int length;
+    };
+    
+    Prefab();
+    Prefab(int width, int height);
+    
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    
+    void SetCell(int x, int y, uint8_t materialID);
+    void ClearCell(int x, int y);
+    bool IsMasked(int x, int y) const;
+    uint8_t GetMaterial(int x, int y) const;
+    
+    // Masked spans of one row, and the particles they copy from. Every edit
+    // keeps its row's spans current, so reading them never writes and one
+    // prefab can be stamped from several threads at once.
+    const Span* GetRowSpans(int y, int& count) const;
+    const Particle* GetRow(int y) const { return &m_Cells[y * m_Width]; }
+    
+    // Copy with a flip or rotation applied
+    Prefab Transformed(PrefabTransform transform) const;
+    
+    // Binary format: header, then either raw material and mask planes or
+    // run-length encoded (mask, material) runs
+    bool Save(const std::string& filename, bool compress = true) const;
+    bool Load(const std::string& filename);
+    
+private:
+    int m_Width;
+    int m_Height;
+    std::vector<Particle> m_Cells;            // Row-major, ready to copy into chunks
+    std::vector<uint8_t> m_Mask;              // 1 where the prefab writes
+    std::vector<std::vector<Span>> m_RowSpans; // Masked spans of each row
+    
+    void BuildRowSpans(int y);
+    void BuildSpans();
+    
+    int FlattenIndex(int x, int y) const { return y * m_Width + x; }
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -1,13 +1,51 @@
 #include "ProceduralGenerator.h"
+#include "CaveSmoothing.h"
 #include "../Simulation/Material.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 namespace Engine {
 
+static uint32_t ChunkSeed(uint32_t seed, const glm::ivec2& coord) {
+    uint32_t h = seed;
+    h ^= static_cast<uint32_t>(coord.x) * 0x9E3779B1U;
+    h = (h << 13) | (h >> 19);
+    h ^= static_cast<uint32_t>(coord.y) * 0x85EBCA77U;
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    return h;
+}
+
+// Write a prefab's masked cells into a chunk with its top-left corner at
+// local (x, y), clipped to the chunk
+static void StampPrefab(Chunk* chunk, const Prefab& prefab, int x, int y) {
+    for (int row = 0; row < prefab.GetHeight(); row++) {
+        int spanCount = 0;
+        const Prefab::Span* spans = prefab.GetRowSpans(row, spanCount);
+        for (int i = 0; i < spanCount; i++) {
+            chunk->BlitRow(x + spans[i].start, y + row, prefab.GetRow(row) + spans[i].start, spans[i].length);
+        }
+    }
+}
+
 ProceduralGenerator::ProceduralGenerator(uint32_t seed)
-    : m_Seed(seed) {
+    : m_Seed(seed), m_Biomes(seed), m_OilPocket(11, 5) {
     m_Random.seed(seed);
+    
+    // Ellipse filling the prefab
+    const float halfWidth = m_OilPocket.GetWidth() * 0.5f;
+    const float halfHeight = m_OilPocket.GetHeight() * 0.5f;
+    for (int y = 0; y < m_OilPocket.GetHeight(); y++) {
+        for (int x = 0; x < m_OilPocket.GetWidth(); x++) {
+            float dx = (x + 0.5f - halfWidth) / halfWidth;
+            float dy = (y + 0.5f - halfHeight) / halfHeight;
+            if (dx * dx + dy * dy <= 1.0f) {
+                m_OilPocket.SetCell(x, y, 8); // Oil (ID 8)
+            }
+        }
+    }
 }
 
 ProceduralGenerator::~ProceduralGenerator() {
@@ -17,23 +55,45 @@ void ProceduralGenerator::GenerateChunk(Chunk* chunk) {
     if (!chunk)
         return;
     
-    // Choose a generation method based on chunk position
+    // Reseed from the coordinate so a chunk comes out the same no matter
+    // which order (or which thread) it is generated in
     glm::ivec2 coord = chunk->GetCoord();
+    m_Random.seed(ChunkSeed(m_Seed, coord));
     
-    // Different areas can have different terrain types
-    if (coord.x < -5 || coord.x > 5) {
-        GenerateCaves(chunk);
-    } else if (coord.y < -3) {
+    // Deep chunks are flat; elsewhere each cell takes cave or terrain
+    // behavior from the biome under it, so a biome edge runs through the
+    // chunk instead of along its border
+    if (coord.y < -3) {
         GenerateFlat(chunk);
-    } else {
-        GenerateTerrain(chunk);
+        return;
+    }
+    
+    BiomeField biome = m_Biomes.EvaluateChunk(coord);
+    const int size = Chunk::CHUNK_SIZE;
+    std::vector<uint8_t> caveCells(size * size);
+    bool anyCave = false;
+    bool anyTerrain = false;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            bool cave = biome.At(x, y).caveWeight > 0.5f;
+            caveCells[y * size + x] = cave;
+            anyCave |= cave;
+            anyTerrain |= !cave;
+        }
+    }
+    
+    if (anyTerrain) {
+        GenerateTerrain(chunk, biome, &caveCells);
+    }
+    if (anyCave) {
+        GenerateCaves(chunk, biome, &caveCells);
     }
 }
 
 void ProceduralGenerator::GenerateFlat(Chunk* chunk) {
     if (!chunk)
         return;
-
+    
     const int GROUND_LEVEL = Chunk::CHUNK_SIZE / 2 + 10;
     
     for (int y = 0; y < Chunk::CHUNK_SIZE; y++) {
@@ -49,26 +109,46 @@ void ProceduralGenerator::GenerateTerrain(Chunk* chunk) {
     if (!chunk)
         return;
     
+    GenerateTerrain(chunk, m_Biomes.EvaluateChunk(chunk->GetCoord()), nullptr);
+}
+
+void ProceduralGenerator::GenerateTerrain(Chunk* chunk, const BiomeField& biome, const std::vector<uint8_t>* caveCells) {
     glm::ivec2 chunkCoord = chunk->GetCoord();
+    const int size = Chunk::CHUNK_SIZE;
     const float SCALE = 0.03f;
-    const int BASE_HEIGHT = Chunk::CHUNK_SIZE / 2;
     
-    for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
+    // Cells left to GenerateCaves
+    auto isCave = [&](int x, int y) {
+        return caveCells && (*caveCells)[y * size + x];
+    };
+    
+    for (int x = 0; x < size; x++) {
         // Generate terrain height using Perlin noise
-        float worldX = x + chunkCoord.x * Chunk::CHUNK_SIZE;
+        float worldX = x + chunkCoord.x * size;
         float noiseValue = Perlin(worldX * SCALE, chunkCoord.y * SCALE, 0.5f, 4);
-        int height = BASE_HEIGHT + static_cast<int>(noiseValue * 20.0f);
+        int offset = static_cast<int>(noiseValue * 20.0f);
         
-        // Cap height to chunk size
-        height = std::min(height, Chunk::CHUNK_SIZE - 1);
+        // Ground level comes from the biome layer at each cell, so the
+        // surface is the first row at or below its own blended ground level
+        int height = size - 1;
+        for (int y = 0; y < size - 1; y++) {
+            if (y >= static_cast<int>(biome.At(x, y).groundLevel) + offset) {
+                height = y;
+                break;
+            }
+        }
         
         // Fill everything below the height with terrain
-        for (int y = height; y < Chunk::CHUNK_SIZE; y++) {
+        for (int y = height; y < size; y++) {
+            if (isCave(x, y))
+                continue;
+            
             if (y == height) {
                 chunk->SetParticle(x, y, Particle(1)); // Sand (ID 1) on top
             } else if (y < height + 5) {
                 // Add some randomness to make it look more natural
-                if (m_Random() % 10 < 8) {
+                const uint32_t sandPercent = static_cast<uint32_t>(biome.At(x, y).sandChance * 100.0f);
+                if (m_Random() % 100 < sandPercent) {
                     chunk->SetParticle(x, y, Particle(1)); // Sand (ID 1)
                 } else {
                     chunk->SetParticle(x, y, Particle(3)); // Stone (ID 3)
@@ -79,10 +159,11 @@ void ProceduralGenerator::GenerateTerrain(Chunk* chunk) {
         }
         
         // Add some water in depressions
-        if (height > BASE_HEIGHT + 5) {
-            int waterLevel = BASE_HEIGHT + 3;
+        const int baseHeight = static_cast<int>(biome.At(x, height).groundLevel);
+        if (height > baseHeight + 5) {
+            int waterLevel = baseHeight + 3;
             for (int y = waterLevel; y < height; y++) {
-                if (chunk->GetParticle(x, y).IsEmpty()) {
+                if (!isCave(x, y) && chunk->GetParticle(x, y).IsEmpty()) {
                     chunk->SetParticle(x, y, Particle(2)); // Water (ID 2)
                 }
             }
@@ -91,11 +172,11 @@ void ProceduralGenerator::GenerateTerrain(Chunk* chunk) {
     
     // Add some random features
     for (int i = 0; i < 10; i++) {
-        int x = m_Random() % Chunk::CHUNK_SIZE;
-        int y = m_Random() % (Chunk::CHUNK_SIZE / 2);
+        int x = m_Random() % size;
+        int y = m_Random() % (size / 2);
         
         // Add a small deposit of wood
-        if (chunk->GetParticle(x, y).IsEmpty()) {
+        if (!isCave(x, y) && chunk->GetParticle(x, y).IsEmpty()) {
             chunk->SetParticle(x, y, Particle(5)); // Wood (ID 5)
             
             // Add a few more wood blocks nearby
@@ -106,37 +187,98 @@ void ProceduralGenerator::GenerateTerrain(Chunk* chunk) {
                 int nx = x + offsetX;
                 int ny = y + offsetY;
                 
-                if (chunk->IsInBounds(nx, ny) && chunk->GetParticle(nx, ny).IsEmpty()) {
+                if (chunk->IsInBounds(nx, ny) && !isCave(nx, ny) && chunk->GetParticle(nx, ny).IsEmpty()) {
                     chunk->SetParticle(nx, ny, Particle(5)); // Wood (ID 5)
                 }
             }
         }
     }
+    
+    // Now and then a pocket of oil in the lower half, only where the row
+    // above it is solid stone so it stays sealed in, and only inside terrain
+    const int OIL_POCKET_PERCENT = 25;
+    if (m_Random() % 100 < OIL_POCKET_PERCENT) {
+        const int width = m_OilPocket.GetWidth();
+        const int height = m_OilPocket.GetHeight();
+        int x = m_Random() % (size - width + 1);
+        int y = size / 2 + m_Random() % (size / 2 - height);
+        
+        bool sealed = true;
+        for (int i = 0; i < width && sealed; i++) {
+            sealed = chunk->GetParticle(x + i, y - 1).materialID == 3; // Stone (ID 3)
+            for (int j = 0; j < height && sealed; j++) {
+                sealed = !isCave(x + i, y + j);
+            }
+        }
+        if (sealed) {
+            StampPrefab(chunk, m_OilPocket, x, y);
+        }
+    }
 }
 
 void ProceduralGenerator::GenerateCaves(Chunk* chunk) {
     if (!chunk)
         return;
     
+    GenerateCaves(chunk, m_Biomes.EvaluateChunk(chunk->GetCoord()), nullptr);
+}
+
+void ProceduralGenerator::GenerateCaves(Chunk* chunk, const BiomeField& biome, const std::vector<uint8_t>* caveCells) {
     glm::ivec2 chunkCoord = chunk->GetCoord();
+    const int size = Chunk::CHUNK_SIZE;
     const float SCALE = 0.05f;
+    const int SMOOTHING_ITERATIONS = 3;
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
     
-    for (int y = 0; y < Chunk::CHUNK_SIZE; y++) {
-        for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
-            float worldX = x + chunkCoord.x * Chunk::CHUNK_SIZE;
-            float worldY = y + chunkCoord.y * Chunk::CHUNK_SIZE;
+    // Raw noise for the chunk plus a one-cell ring from the neighbors,
+    // row-major over [-1, size] in both axes
+    const int stride = size + 2;
+    std::vector<float> noise(stride * stride);
+    for (int y = -1; y <= size; y++) {
+        for (int x = -1; x <= size; x++) {
+            float worldX = x + chunkCoord.x * size;
+            float worldY = y + chunkCoord.y * size;
+            noise[(y + 1) * stride + (x + 1)] = Perlin(worldX * SCALE, worldY * SCALE, 0.5f, 4);
+        }
+    }
+    
+    // Walls are stone or the loose band around it
+    auto isRawWall = [&](int x, int y) {
+        return noise[(y + 1) * stride + (x + 1)] > biome.At(x, y).caveThreshold - 0.1f;
+    };
+    
+    // Smooth out speckles with the bitboard cave rule. The halo stays at the
+    // neighbors' raw noise stage, so it's the same no matter which chunks exist.
+    CaveBitboard walls;
+    const bool smooth = size == CaveBitboard::SIZE;
+    if (smooth) {
+        for (int y = -1; y <= size; y++) {
+            for (int x = -1; x <= size; x++) {
+                walls.SetWall(x, y, isRawWall(x, y));
+            }
+        }
+        SmoothCaveBitboard(walls, SMOOTHING_ITERATIONS);
+    }
+    
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            // Cells left to GenerateTerrain
+            if (caveCells && !(*caveCells)[y * size + x])
+                continue;
             
-            float noiseValue = Perlin(worldX * SCALE, worldY * SCALE, 0.5f, 4);
+            float noiseValue = noise[(y + 1) * stride + (x + 1)];
+            BiomeParams params = biome.At(x, y);
+            bool wall = smooth ? walls.IsWall(x, y) : isRawWall(x, y);
             
-            if (noiseValue > 0.3f) {
-                chunk->SetParticle(x, y, Particle(3)); // Stone (ID 3)
-            } else if (noiseValue > 0.2f) {
-                if (m_Random() % 10 < 8) {
-                    chunk->SetParticle(x, y, Particle(3)); // Stone (ID 3)
-                } else {
+            if (wall) {
+                if (noiseValue > params.caveThreshold - 0.1f && noiseValue <= params.caveThreshold &&
+                    chance(m_Random) <= params.sandChance * 0.25f) {
+                    // Loose cave walls hold a quarter of the biome's sand share
                     chunk->SetParticle(x, y, Particle(1)); // Sand (ID 1)
+                } else {
+                    chunk->SetParticle(x, y, Particle(3)); // Stone (ID 3)
                 }
-            } else if (noiseValue > 0.0f && m_Random() % 20 == 0) {
+            } else if (noiseValue > 0.0f && chance(m_Random) < params.waterChance) {
                 chunk->SetParticle(x, y, Particle(2)); // Some water pools (ID 2)
             }
         }
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "Chunk.h"
+#include "BiomeMap.h"
+#include "Prefab.h"
 #include <random>
+#include <vector>
 #include <glm/glm.hpp>
 
 namespace Engine {
@@ -21,6 +24,13 @@ public:
 private:
     std::mt19937 m_Random;
     uint32_t m_Seed;
+    BiomeMap m_Biomes;
+    Prefab m_OilPocket;   // Lens of oil sealed into deep stone
+    
+    // Fill only the cells caveCells marks as terrain (0) or cave (1);
+    // nullptr fills the whole chunk
+    void GenerateTerrain(Chunk* chunk, const BiomeField& biome, const std::vector<uint8_t>* caveCells);
+    void GenerateCaves(Chunk* chunk, const BiomeField& biome, const std::vector<uint8_t>* caveCells);
     
     // Noise generation helpers
     float Noise(float x, float y);
@@ -0,0 +1,299 @@
+#include "VisibilityMap.h"
+#include "WorldSnapshot.h"
+#include "Chunk.h"
+#include "../Simulation/Material.h"
+#include <algorithm>
+
+namespace Engine {
+
+static const int WORD_BITS = 64;
+
+// Bitmaps are stored a chunk at a time, 64 words per chunk, so consecutive
+// words of one window line are a chunk apart
+static const int LINE_STRIDE = Chunk::CHUNK_SIZE;
+
+// Floor division, so negative cells land in the chunk to their left
+static int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// std::floor without the library call; slopes stay well inside int range
+static int FloorToInt(float value) {
+    const int truncated = static_cast<int>(value);
+    return truncated - (value < static_cast<float>(truncated));
+}
+
+// Index of the lowest set bit; bits must not be 0
+static int LowestBit(uint64_t bits) {
+    static const int DEBRUIJN_INDEX[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+    };
+    return DEBRUIJN_INDEX[((bits & (~bits + 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+// First position in [from, to] of a line whose bit is set (or clear);
+// to + 1 if there is none
+static int FindBit(const uint64_t* line, int from, int to, bool set) {
+    int word = from / WORD_BITS;
+    uint64_t bits = (set ? line[word * LINE_STRIDE] : ~line[word * LINE_STRIDE]) & (~0ULL << (from % WORD_BITS));
+    for (;;) {
+        if (bits != 0) {
+            return std::min(word * WORD_BITS + LowestBit(bits), to + 1);
+        }
+        word++;
+        if (word * WORD_BITS > to)
+            return to + 1;
+        bits = set ? line[word * LINE_STRIDE] : ~line[word * LINE_STRIDE];
+    }
+}
+
+// Set the bits of positions [from, to] of a line
+static void SetRange(uint64_t* line, int from, int to) {
+    const int firstWord = from / WORD_BITS;
+    const int lastWord = to / WORD_BITS;
+    const uint64_t firstMask = ~0ULL << (from % WORD_BITS);
+    const uint64_t lastMask = ~0ULL >> (WORD_BITS - 1 - to % WORD_BITS);
+    if (firstWord == lastWord) {
+        line[firstWord * LINE_STRIDE] |= firstMask & lastMask;
+        return;
+    }
+    line[firstWord * LINE_STRIDE] |= firstMask;
+    for (int word = firstWord + 1; word < lastWord; word++) {
+        line[word * LINE_STRIDE] = ~0ULL;
+    }
+    line[lastWord * LINE_STRIDE] |= lastMask;
+}
+
+// Swap rows and columns of a 64x64 bit matrix: bit x of word y moves to
+// bit y of word x. Swaps ever smaller blocks across the diagonal.
+static void Transpose(uint64_t* words) {
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (int width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+        for (int k = 0; k < 64; k = ((k | width) + 1) & ~width) {
+            const uint64_t swapped = ((words[k] >> width) ^ words[k | width]) & mask;
+            words[k] ^= swapped << width;
+            words[k | width] ^= swapped;
+        }
+    }
+}
+
+VisibilityMap::VisibilityMap()
+    : m_ComputeCount(0)
+    , m_WindowOrigin(0, 0)
+    , m_WindowChunks(0)
+    , m_VisibleChunkCount(0) {
+    m_Opaque.fill(0);
+}
+
+void VisibilityMap::Compute(const WorldSnapshot& snapshot, const glm::ivec2& viewer, int radius) {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    radius = std::clamp(radius, 0, MAX_RADIUS);
+    m_ComputeCount++;
+    
+    const MaterialDatabase& materials = MaterialDatabase::Get();
+    for (int id = 0; id < 256; id++) {
+        m_Opaque[id] = id != 0 && materials.HasMaterial(static_cast<uint8_t>(id))
+            && materials.GetMaterial(static_cast<uint8_t>(id)).isSolid;
+    }
+    
+    // Chunk-aligned window, so a chunk row is exactly one word of a window line
+    const int reach = (radius + chunkSize - 1) / chunkSize;
+    const glm::ivec2 viewerChunk(FloorDiv(viewer.x, chunkSize), FloorDiv(viewer.y, chunkSize));
+    m_WindowOrigin = viewerChunk - glm::ivec2(reach);
+    m_WindowChunks = 2 * reach + 1;
+    
+    // Every solid word is written by RefreshOccupancy
+    const size_t wordCount = static_cast<size_t>(m_WindowChunks) * m_WindowChunks * chunkSize;
+    m_SolidRows.resize(wordCount);
+    m_SolidColumns.resize(wordCount);
+    m_Masks.assign(wordCount, 0);
+    m_VisibleColumns.assign(wordCount, 0);
+    
+    RefreshOccupancy(snapshot);
+    
+    // The viewer sees its own cell, then each quadrant: up and down scan
+    // window rows straight into the masks, left and right scan window columns
+    const glm::ivec2 local = viewer - m_WindowOrigin * chunkSize;
+    m_Masks[LineOffset(local.y) + static_cast<size_t>(local.x / WORD_BITS) * LINE_STRIDE] |= 1ULL << (local.x % WORD_BITS);
+    CastQuadrant(m_SolidRows, m_Masks, local.y, local.x, -1, radius);
+    CastQuadrant(m_SolidRows, m_Masks, local.y, local.x, 1, radius);
+    CastQuadrant(m_SolidColumns, m_VisibleColumns, local.x, local.y, -1, radius);
+    CastQuadrant(m_SolidColumns, m_VisibleColumns, local.x, local.y, 1, radius);
+    
+    BuildMasks();
+}
+
+size_t VisibilityMap::LineOffset(int line) const {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    return static_cast<size_t>(line / chunkSize) * m_WindowChunks * chunkSize + line % chunkSize;
+}
+
+void VisibilityMap::RefreshOccupancy(const WorldSnapshot& snapshot) {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    const int tileSize = Chunk::RENDER_TILE_SIZE;
+    const int tilesPerRow = chunkSize / tileSize;
+    
+    for (int windowY = 0; windowY < m_WindowChunks; windowY++) {
+        for (int windowX = 0; windowX < m_WindowChunks; windowX++) {
+            const glm::ivec2 coord = m_WindowOrigin + glm::ivec2(windowX, windowY);
+            uint64_t* rows = &m_SolidRows[LineOffset(windowY * chunkSize) + static_cast<size_t>(windowX) * LINE_STRIDE];
+            uint64_t* columns = &m_SolidColumns[LineOffset(windowX * chunkSize) + static_cast<size_t>(windowY) * LINE_STRIDE];
+            const ChunkSnapshot* chunk = snapshot.GetChunk(coord);
+            if (!chunk) {
+                std::fill(rows, rows + chunkSize, 0);
+                std::fill(columns, columns + chunkSize, 0);
+                continue;
+            }
+            
+            auto [it, inserted] = m_Occupancy.try_emplace(coord);
+            ChunkOccupancy& occupancy = it->second;
+            occupancy.lastUsed = m_ComputeCount;
+            if (inserted || chunk->changedTick > occupancy.tick) {
+                // Only the rows of tiles that changed since the last refresh
+                for (int tileY = 0; tileY < tilesPerRow; tileY++) {
+                    bool changed = inserted;
+                    for (int tileX = 0; tileX < tilesPerRow && !changed; tileX++) {
+                        changed = chunk->tileTicks[tileY * tilesPerRow + tileX] > occupancy.tick;
+                    }
+                    if (!changed)
+                        continue;
+                    
+                    for (int y = tileY * tileSize; y < (tileY + 1) * tileSize; y++) {
+                        const uint8_t* cells = chunk->GetRow(y);
+                        uint64_t bits = 0;
+                        for (int x = 0; x < chunkSize; x++) {
+                            bits |= static_cast<uint64_t>(m_Opaque[cells[x]]) << x;
+                        }
+                        occupancy.rows[y] = bits;
+                    }
+                }
+                occupancy.columns = occupancy.rows;
+                Transpose(occupancy.columns.data());
+                occupancy.tick = chunk->capturedTick;
+            }
+            
+            std::copy(occupancy.rows.begin(), occupancy.rows.end(), rows);
+            std::copy(occupancy.columns.begin(), occupancy.columns.end(), columns);
+        }
+    }
+    
+    // Forget chunks that left the window
+    for (auto it = m_Occupancy.begin(); it != m_Occupancy.end();) {
+        if (it->second.lastUsed != m_ComputeCount) {
+            it = m_Occupancy.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void VisibilityMap::CastQuadrant(const std::vector<uint64_t>& solid, std::vector<uint64_t>& visible,
+                                 int viewerLine, int viewerPosition, int direction, int radius) {
+    const int lineLength = m_WindowChunks * Chunk::CHUNK_SIZE;
+    
+    // Each scan covers the cells of one line between two slopes (offset
+    // along the line per line of depth); a run of open cells in it starts a
+    // scan of the next line, narrowed to what shows through the run. A whole
+    // line is scanned before the next, left to right, so both bitmaps are
+    // walked in order.
+    m_Scans.clear();
+    m_Scans.push_back({-1.0f, 1.0f});
+    for (int depth = 1; depth <= radius && !m_Scans.empty(); depth++) {
+        const int line = viewerLine + direction * depth;
+        if (line < 0 || line >= lineLength)
+            break;
+        
+        const uint64_t* solidLine = &solid[LineOffset(line)];
+        uint64_t* visibleLine = &visible[LineOffset(line)];
+        m_NextScans.clear();
+        for (const Scan& scan : m_Scans) {
+            // Cells whose centers lie within the slopes, ties going outward
+            const int minOffset = FloorToInt(depth * scan.startSlope + 0.5f);
+            const int maxOffset = -FloorToInt(0.5f - depth * scan.endSlope);
+            const int from = std::max(0, viewerPosition + std::max(minOffset, -radius));
+            const int to = std::min(lineLength - 1, viewerPosition + std::min(maxOffset, radius));
+            if (from > to)
+                continue;
+            
+            SetRange(visibleLine, from, to);
+            
+            int position = from;
+            while (position <= to) {
+                const int runStart = FindBit(solidLine, position, to, false);
+                if (runStart > to)
+                    break;
+                const int runEnd = FindBit(solidLine, runStart, to, true) - 1;
+                
+                const int startOffset = runStart - viewerPosition;
+                const int endOffset = runEnd - viewerPosition;
+                m_NextScans.push_back({
+                    startOffset == minOffset ? scan.startSlope : (2.0f * startOffset - 1.0f) / (2.0f * depth),
+                    endOffset == maxOffset ? scan.endSlope : (2.0f * endOffset + 1.0f) / (2.0f * depth)
+                });
+                
+                position = runEnd + 2;
+            }
+        }
+        m_Scans.swap(m_NextScans);
+    }
+}
+
+void VisibilityMap::BuildMasks() {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    const int chunkCount = m_WindowChunks * m_WindowChunks;
+    m_ChunkVisible.assign(chunkCount, 0);
+    m_VisibleChunkCount = 0;
+    
+    for (int windowY = 0; windowY < m_WindowChunks; windowY++) {
+        for (int windowX = 0; windowX < m_WindowChunks; windowX++) {
+            const int index = windowY * m_WindowChunks + windowX;
+            uint64_t* mask = &m_Masks[static_cast<size_t>(index) * chunkSize];
+            
+            // Column scans are stored transposed; turn them back into rows
+            uint64_t* columns = &m_VisibleColumns[static_cast<size_t>(windowX * m_WindowChunks + windowY) * chunkSize];
+            uint64_t fromColumns = 0;
+            for (int i = 0; i < chunkSize; i++) {
+                fromColumns |= columns[i];
+            }
+            if (fromColumns != 0) {
+                Transpose(columns);
+            }
+            
+            uint64_t any = 0;
+            for (int i = 0; i < chunkSize; i++) {
+                mask[i] |= columns[i];
+                any |= mask[i];
+            }
+            if (any != 0) {
+                m_ChunkVisible[index] = 1;
+                m_VisibleChunkCount++;
+            }
+        }
+    }
+}
+
+const uint64_t* VisibilityMap::GetChunkMask(const glm::ivec2& chunkCoord) const {
+    const glm::ivec2 windowCoord = chunkCoord - m_WindowOrigin;
+    if (windowCoord.x < 0 || windowCoord.y < 0 || windowCoord.x >= m_WindowChunks || windowCoord.y >= m_WindowChunks)
+        return nullptr;
+    
+    const int index = windowCoord.y * m_WindowChunks + windowCoord.x;
+    return m_ChunkVisible[index] ? &m_Masks[static_cast<size_t>(index) * Chunk::CHUNK_SIZE] : nullptr;
+}
+
+bool VisibilityMap::IsVisible(int worldX, int worldY) const {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    const glm::ivec2 chunkCoord(FloorDiv(worldX, chunkSize), FloorDiv(worldY, chunkSize));
+    const uint64_t* mask = GetChunkMask(chunkCoord);
+    if (!mask)
+        return false;
+    
+    const int localX = worldX - chunkCoord.x * chunkSize;
+    const int localY = worldY - chunkCoord.y * chunkSize;
+    return (mask[localY] >> localX) & 1;
+}
+
+} // namespace Engine
\ No newline at end of file
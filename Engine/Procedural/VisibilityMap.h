@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+namespace Engine {
+
+class WorldSnapshot;
+
+// Line of sight from one cell, for fog of war and for telling what needs
+// full detail. Solid materials block sight and are seen themselves; all
+// other cells are see-through. Visibility comes from recursive
+// shadowcasting over bitmaps of the chunks around the viewer: a chunk row
+// is one 64-bit word, so each scanned row is split into runs of open cells
+// a word at a time instead of cell by cell.
+class VisibilityMap {
+public:
+    static constexpr int MAX_RADIUS = 2048;   // Cells
+    
+    VisibilityMap();
+    
+    // Recompute what the viewer cell sees within radius cells along either
+    // axis. Chunks missing from the snapshot count as open.
+    void Compute(const WorldSnapshot& snapshot, const glm::ivec2& viewer, int radius);
+    
+    // Visible cells of a chunk, word y holding bit x for cell (x, y); nullptr
+    // when nothing in the chunk is visible
+    const uint64_t* GetChunkMask(const glm::ivec2& chunkCoord) const;
+    bool IsChunkVisible(const glm::ivec2& chunkCoord) const { return GetChunkMask(chunkCoord) != nullptr; }
+    bool IsVisible(int worldX, int worldY) const;
+    
+    int GetVisibleChunkCount() const { return m_VisibleChunkCount; }
+    
+private:
+    // Solid cells of one chunk, by rows and by columns (bit y of word x),
+    // refreshed for the tiles that changed since tick
+    struct ChunkOccupancy {
+        std::array<uint64_t, 64> rows;
+        std::array<uint64_t, 64> columns;
+        uint64_t tick;
+        uint64_t lastUsed;   // Compute call that last needed it
+    };
+    std::unordered_map<glm::ivec2, ChunkOccupancy> m_Occupancy;
+    uint64_t m_ComputeCount;
+    
+    std::array<uint8_t, 256> m_Opaque;
+    
+    // Window of chunks around the viewer: m_WindowChunks per side starting at
+    // m_WindowOrigin. Lines are rows (y) or columns (x) of the window, each
+    // m_WindowChunks words long. Bitmaps hold 64 words per chunk, the
+    // column bitmaps with chunks in x-major order.
+    glm::ivec2 m_WindowOrigin;
+    int m_WindowChunks;
+    std::vector<uint64_t> m_SolidRows, m_SolidColumns;
+    std::vector<uint64_t> m_VisibleColumns;
+    
+    // Results, 64 words per window chunk, and which chunks have any bit set
+    std::vector<uint64_t> m_Masks;
+    std::vector<uint8_t> m_ChunkVisible;
+    int m_VisibleChunkCount;
+    
+    // Scans of the current line of a quadrant, and of the line after it
+    struct Scan {
+        float startSlope;
+        float endSlope;
+    };
+    std::vector<Scan> m_Scans, m_NextScans;
+    
+    // First word of a window line in a bitmap
+    size_t LineOffset(int line) const;
+    
+    void RefreshOccupancy(const WorldSnapshot& snapshot);
+    void CastQuadrant(const std::vector<uint64_t>& solid, std::vector<uint64_t>& visible,
+                      int viewerLine, int viewerPosition, int direction, int radius);
+    void BuildMasks();
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -1,25 +1,32 @@
 #include "World.h"
+#include "../Core/JobSystem.h"
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <nlohmann/json.hpp>
 #include <thread>
 #include <future>
 
 namespace Engine {
 
 World::World()
-    : m_PlayerPosition(0.0f, 0.0f), m_Running(true) {
-    const unsigned int threadCount = std::thread::hardware_concurrency();
-    std::cout << "Initializing world with " << threadCount << " worker threads" << std::endl;
+    : m_PlayerPosition(0.0f, 0.0f), m_StreamingEnabled(true), m_GeneratedSettleTicks(0), m_Running(true), m_UpdateThreadCount(0) {
+    const unsigned int threadCount = JobSystem::Get().GetWorkerCount() + 1;
+    std::cout << "Initializing world with " << threadCount << " threads" << std::endl;
 }
 
 World::~World() {
     m_Running = false;
     
-    // Wait for all worker threads to finish
-    for (auto& thread : m_WorkerThreads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
+    // Settling tasks write into chunks we own, so stop them and let them
+    // finish first; jobs that haven't started yet don't generate anything
+    for (auto& pending : m_PendingChunks) {
+        pending.control->stop = true;
+        pending.control->claimed = true;
+    }
+    for (auto& pending : m_PendingChunks) {
+        pending.settled.wait();
     }
     
     // Clear all chunks
@@ -27,8 +34,13 @@ World::~World() {
 }
 
 void World::Update(float dt) {
+    // Add chunks that finished settling since the last update
+    PublishSettledChunks();
+    
     // Stream chunks based on player position
-    StreamChunks();
+    if (m_StreamingEnabled) {
+        StreamChunks();
+    }
     
     // Update chunks in parallel
     UpdateChunksMultiThreaded(dt);
@@ -50,6 +62,22 @@ Chunk* World::GetChunk(const glm::ivec2& coord) {
     return nullptr;
 }
 
+const Chunk* World::GetChunk(const glm::ivec2& coord) const {
+    // Like the const GetParticle, this doesn't lock; readers run between updates
+    auto it = m_Chunks.find(coord);
+    if (it != m_Chunks.end()) {
+        return it->second.get();
+    }
+    
+    return nullptr;
+}
+
+void World::ForEachChunk(const std::function<void(const Chunk&)>& visit) const {
+    for (const auto& [coord, chunk] : m_Chunks) {
+        visit(*chunk);
+    }
+}
+
 Chunk* World::CreateChunk(const glm::ivec2& coord) {
     std::lock_guard<std::mutex> lock(m_ChunkMutex);
     
@@ -59,6 +87,11 @@ Chunk* World::CreateChunk(const glm::ivec2& coord) {
         return it->second.get();
     }
     
+    // A generated chunk on its way beats an empty one
+    if (Chunk* pending = TakePendingChunk(coord)) {
+        return pending;
+    }
+    
     // Create a new chunk
     auto chunk = std::make_unique<Chunk>(coord);
     Chunk* result = chunk.get();
@@ -133,21 +166,169 @@ void World::SetParticle(int worldX, int worldY, const Particle& particle) {
     }
 }
 
+void World::Stamp(const Prefab& prefab, const glm::ivec2& position, PrefabTransform transform) {
+    if (transform != PrefabTransform::None) {
+        Stamp(prefab.Transformed(transform), position, PrefabTransform::None);
+        return;
+    }
+    
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    
+    // Spans on neighboring rows mostly land in the same chunk
+    Chunk* chunk = nullptr;
+    glm::ivec2 currentCoord(0, 0);
+    
+    for (int y = 0; y < prefab.GetHeight(); y++) {
+        int spanCount = 0;
+        const Prefab::Span* spans = prefab.GetRowSpans(y, spanCount);
+        const Particle* row = prefab.GetRow(y);
+        const int worldY = position.y + y;
+        
+        for (int i = 0; i < spanCount; i++) {
+            int worldX = position.x + spans[i].start;
+            const int worldEnd = worldX + spans[i].length;
+            const Particle* source = row + spans[i].start;
+            
+            // Split the span where it crosses chunk borders
+            while (worldX < worldEnd) {
+                glm::ivec2 chunkCoord = WorldToChunkCoord(worldX, worldY);
+                glm::ivec2 localCoord = WorldToLocalCoord(worldX, worldY);
+                
+                if (!chunk || chunkCoord != currentCoord) {
+                    chunk = CreateChunk(chunkCoord); // Takes over a pending chunk rather than replace it
+                    currentCoord = chunkCoord;
+                }
+                
+                int count = std::min(worldEnd - worldX, chunkSize - localCoord.x);
+                chunk->BlitRow(localCoord.x, localCoord.y, source, count);
+                
+                worldX += count;
+                source += count;
+            }
+        }
+    }
+}
+
 void World::SetPlayerPosition(const glm::vec2& position) {
     m_PlayerPosition = position;
 }
 
+void World::SetUpdateThreadCount(unsigned int threadCount) {
+    std::lock_guard<std::mutex> lock(m_ChunkMutex);
+    m_UpdateThreadCount = threadCount;
+}
+
+void World::QueueGeneratedChunk(std::unique_ptr<Chunk> chunk, int maxSettleTicks) {
+    QueueChunk(std::move(chunk), nullptr, maxSettleTicks);
+}
+
+void World::QueueChunk(std::unique_ptr<Chunk> chunk, ChunkGenerator generate, int maxSettleTicks) {
+    if (!chunk)
+        return;
+    
+    std::lock_guard<std::mutex> lock(m_ChunkMutex);
+    
+    if (maxSettleTicks <= 0 && !generate) {
+        glm::ivec2 coord = chunk->GetCoord();
+        m_Chunks[coord] = std::move(chunk);
+        return;
+    }
+    
+    // The chunk isn't in m_Chunks yet, so the worker has it to itself
+    // unless TakePendingChunk claims it before the job starts
+    Chunk* target = chunk.get();
+    PendingChunk pending;
+    pending.chunk = std::move(chunk);
+    pending.control = std::make_shared<SettleControl>();
+    pending.generate = generate;
+    pending.settled = JobSystem::Get().Submit([target, maxSettleTicks, generate, control = pending.control]() {
+        if (control->claimed.exchange(true))
+            return;
+        if (generate) {
+            generate(*target);
+        }
+        SettleChunk(*target, maxSettleTicks, &control->stop);
+    });
+    m_PendingChunks.push_back(std::move(pending));
+}
+
+bool World::IsChunkPending(const glm::ivec2& coord) {
+    std::lock_guard<std::mutex> lock(m_ChunkMutex);
+    
+    for (const auto& pending : m_PendingChunks) {
+        if (pending.chunk->GetCoord() == coord)
+            return true;
+    }
+    
+    return false;
+}
+
+Chunk* World::TakePendingChunk(const glm::ivec2& coord) {
+    for (size_t i = 0; i < m_PendingChunks.size(); i++) {
+        PendingChunk& pending = m_PendingChunks[i];
+        if (pending.chunk->GetCoord() != coord)
+            continue;
+        
+        // If the job already claimed the chunk, it stops after generating it
+        // or after its current tick; otherwise generating is left to us
+        pending.control->stop = true;
+        if (pending.control->claimed.exchange(true)) {
+            pending.settled.wait();
+        } else if (pending.generate) {
+            pending.generate(*pending.chunk);
+        }
+        
+        Chunk* result = pending.chunk.get();
+        m_Chunks[coord] = std::move(pending.chunk);
+        m_PendingChunks[i] = std::move(m_PendingChunks.back());
+        m_PendingChunks.pop_back();
+        return result;
+    }
+    
+    return nullptr;
+}
+
+int World::SettleChunk(Chunk& chunk, int maxTicks, const std::atomic<bool>* stop) {
+    const float SETTLE_DT = 1.0f / 60.0f;
+    
+    int ticks = 0;
+    while (ticks < maxTicks && chunk.IsDirty() && !(stop && *stop)) {
+        chunk.Update(SETTLE_DT);
+        ticks++;
+    }
+    
+    return ticks;
+}
+
+void World::PublishSettledChunks() {
+    std::lock_guard<std::mutex> lock(m_ChunkMutex);
+    
+    for (size_t i = 0; i < m_PendingChunks.size();) {
+        PendingChunk& pending = m_PendingChunks[i];
+        if (pending.settled.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            i++;
+            continue;
+        }
+        
+        // Edits take pending chunks over, so only a chunk loaded over this
+        // coord in the meantime can be here already; the loaded one wins
+        glm::ivec2 coord = pending.chunk->GetCoord();
+        if (m_Chunks.find(coord) == m_Chunks.end()) {
+            m_Chunks[coord] = std::move(pending.chunk);
+        }
+        
+        m_PendingChunks[i] = std::move(m_PendingChunks.back());
+        m_PendingChunks.pop_back();
+    }
+}
+
 void World::Save(const std::string& directory) {
     std::filesystem::create_directories(directory);
     
     std::lock_guard<std::mutex> lock(m_ChunkMutex);
     
     for (const auto& [coord, chunk] : m_Chunks) {
-        std::string filename = directory + "/chunk_" + 
-            std::to_string(coord.x) + "_" + 
-            std::to_string(coord.y) + ".bin";
-        
-        chunk->Save(filename);
+        chunk->Save(ChunkFilename(directory, coord));
     }
     
     std::cout << "Saved " << m_Chunks.size() << " chunks to " << directory << std::endl;
@@ -164,13 +345,13 @@ void World::Load(const std::string& directory) {
     // Clear existing chunks
     m_Chunks.clear();
     
-    // Load all chunk files
+    // Find the chunk files; assuming format: chunk_X_Y.bin
+    std::vector<std::pair<glm::ivec2, std::string>> files;
     for (const auto& entry : std::filesystem::directory_iterator(directory)) {
         if (entry.is_regular_file() && entry.path().extension() == ".bin") {
             std::string filename = entry.path().string();
             
             // Extract coordinates from filename
-            // Assuming format: chunk_X_Y.bin
             std::string basename = entry.path().stem().string();
             size_t firstUnderscore = basename.find('_');
             size_t secondUnderscore = basename.find('_', firstUnderscore + 1);
@@ -180,15 +361,7 @@ void World::Load(const std::string& directory) {
                 std::string yStr = basename.substr(secondUnderscore + 1);
                 
                 try {
-                    int x = std::stoi(xStr);
-                    int y = std::stoi(yStr);
-                    
-                    glm::ivec2 coord(x, y);
-                    auto chunk = std::make_unique<Chunk>(coord);
-                    
-                    if (chunk->Load(filename)) {
-                        m_Chunks[coord] = std::move(chunk);
-                    }
+                    files.emplace_back(glm::ivec2(std::stoi(xStr), std::stoi(yStr)), filename);
                 }
                 catch (const std::exception& e) {
                     std::cerr << "Error parsing chunk filename: " << filename << " - " << e.what() << std::endl;
@@ -197,9 +370,101 @@ void World::Load(const std::string& directory) {
         }
     }
     
+    // Read and decode them in parallel; each task fills only its own slot
+    std::vector<std::unique_ptr<Chunk>> loaded(files.size());
+    JobSystem::Get().ParallelFor(0, static_cast<int>(files.size()), [&](int index) {
+        auto chunk = std::make_unique<Chunk>(files[index].first);
+        if (chunk->Load(files[index].second)) {
+            loaded[index] = std::move(chunk);
+        }
+    });
+    
+    for (auto& chunk : loaded) {
+        if (chunk) {
+            glm::ivec2 coord = chunk->GetCoord();
+            m_Chunks[coord] = std::move(chunk);
+        }
+    }
+    
     std::cout << "Loaded " << m_Chunks.size() << " chunks from " << directory << std::endl;
 }
 
+Chunk* World::LoadChunk(const std::string& directory, const glm::ivec2& coord) {
+    std::string filename = ChunkFilename(directory, coord);
+    if (!std::filesystem::exists(filename))
+        return nullptr;
+    
+    auto chunk = std::make_unique<Chunk>(coord);
+    if (!chunk->Load(filename))
+        return nullptr;
+    
+    std::lock_guard<std::mutex> lock(m_ChunkMutex);
+    Chunk* result = chunk.get();
+    m_Chunks[coord] = std::move(chunk);
+    return result;
+}
+
+std::string World::ChunkFilename(const std::string& directory, const glm::ivec2& coord) {
+    return directory + "/chunk_" + 
+        std::to_string(coord.x) + "_" + 
+        std::to_string(coord.y) + ".bin";
+}
+
+bool World::SaveSeed(const std::string& directory, uint32_t seed) {
+    std::ofstream file(directory + "/world.json");
+    if (!file.is_open()) {
+        std::cerr << "Failed to write world info to " << directory << std::endl;
+        return false;
+    }
+    
+    nlohmann::json json;
+    json["seed"] = seed;
+    file << json.dump(4) << std::endl;
+    return true;
+}
+
+bool World::LoadSeed(const std::string& directory, uint32_t& seed) {
+    std::ifstream file(directory + "/world.json");
+    if (!file.is_open())
+        return false;
+    
+    try {
+        nlohmann::json json;
+        file >> json;
+        if (!json.contains("seed"))
+            return false;
+        seed = json["seed"].get<uint32_t>();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading world info from " << directory << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void World::SetStreamingDirectory(const std::string& directory) {
+    m_StreamingDirectory = directory;
+}
+
+void World::SetChunkGenerator(ChunkGenerator generate, int maxSettleTicks) {
+    m_ChunkGenerator = std::move(generate);
+    m_GeneratedSettleTicks = maxSettleTicks;
+}
+
+void World::RequestChunk(const glm::ivec2& coord) {
+    if (GetChunk(coord) || IsChunkPending(coord))
+        return;
+    
+    if (!m_StreamingDirectory.empty() && LoadChunk(m_StreamingDirectory, coord))
+        return;
+    
+    if (!m_ChunkGenerator) {
+        CreateChunk(coord);
+        return;
+    }
+    
+    QueueChunk(std::make_unique<Chunk>(coord), m_ChunkGenerator, m_GeneratedSettleTicks);
+}
+
 void World::UpdateChunksAroundPlayer() {
     glm::ivec2 playerChunkCoord = WorldToChunkCoord(
         static_cast<int>(m_PlayerPosition.x),
@@ -209,12 +474,7 @@ void World::UpdateChunksAroundPlayer() {
     // Create chunks in a square around the player
     for (int y = -m_ChunkLoadRadius; y <= m_ChunkLoadRadius; y++) {
         for (int x = -m_ChunkLoadRadius; x <= m_ChunkLoadRadius; x++) {
-            glm::ivec2 chunkCoord = playerChunkCoord + glm::ivec2(x, y);
-            
-            // Check if chunk exists, create if it doesn't
-            if (!GetChunk(chunkCoord)) {
-                CreateChunk(chunkCoord);
-            }
+            RequestChunk(playerChunkCoord + glm::ivec2(x, y));
         }
     }
 }
@@ -271,66 +531,35 @@ glm::ivec2 World::WorldToLocalCoord(int worldX, int worldY) const {
 }
 
 void World::UpdateChunksMultiThreaded(float dt) {
-    // TEMPORARY - Use single-threaded updates to isolate issues
     std::lock_guard<std::mutex> lock(m_ChunkMutex);
     
-    // Debug output - how many chunks need updating?
-    int dirtyChunks = 0;
-    for (auto& [coord, chunk] : m_Chunks) {
-        if (chunk->IsDirty()) {
-            dirtyChunks++;
-        }
-    }
-    
-    if (dirtyChunks > 0) {
-        std::cout << "Updating " << dirtyChunks << " dirty chunks" << std::endl;
+    // Four-color checkerboard: no two chunks of a phase touch, not even at a
+    // corner, so a kernel may reach into the neighbors of its own chunk
+    // without racing another update. Phases run one after another.
+    for (auto& phase : m_PhaseChunks) {
+        phase.clear();
     }
-    
-    // Update all chunks sequentially for now to avoid threading issues
     for (auto& [coord, chunk] : m_Chunks) {
         if (chunk->IsDirty()) {
-            // Just directly update the chunk
-            chunk->Update(dt);
+            m_PhaseChunks[(coord.x & 1) | ((coord.y & 1) << 1)].push_back(chunk.get());
         }
     }
     
-    /* DISABLED MULTITHREADED UPDATES FOR DEBUGGING
-    // Use a checkerboard pattern for updating to avoid race conditions
-    // This divides the chunks into 4 groups that can be updated in parallel
-    
-    for (int phase = 0; phase < 4; phase++) {
-        std::vector<std::future<void>> futures;
-        
-        std::lock_guard<std::mutex> lock(m_ChunkMutex);
-        
-        for (auto& [coord, chunk] : m_Chunks) {
-            // Only update chunks that have changed
-            if (!chunk->IsDirty())
-                continue;
-            
-            // Check if this chunk belongs to the current phase
-            bool evenX = (coord.x % 2) == 0;
-            bool evenY = (coord.y % 2) == 0;
-            
-            int chunkPhase = 0;
-            if (evenX && evenY) chunkPhase = 0;
-            else if (!evenX && evenY) chunkPhase = 1;
-            else if (evenX && !evenY) chunkPhase = 2;
-            else if (!evenX && !evenY) chunkPhase = 3;
-            
-            if (chunkPhase == phase) {
-                futures.push_back(std::async(std::launch::async, [&chunk, dt]() {
-                    chunk->Update(dt);
-                }));
+    if (m_UpdateThreadCount == 1) {
+        for (const auto& phase : m_PhaseChunks) {
+            for (Chunk* chunk : phase) {
+                chunk->Update(dt);
             }
         }
-        
-        // Wait for all updates in this phase to complete
-        for (auto& future : futures) {
-            future.wait();
-        }
+        return;
+    }
+    
+    // The updating thread counts toward the cap along with the workers
+    for (const auto& phase : m_PhaseChunks) {
+        JobSystem::Get().ParallelFor(0, static_cast<int>(phase.size()), [&phase, dt](int index) {
+            phase[index]->Update(dt);
+        }, 1, m_UpdateThreadCount);
     }
-    */
 }
 
 } // namespace Engine
\ No newline at end of file
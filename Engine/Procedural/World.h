@@ -1,11 +1,16 @@
 #pragma once
 
 #include "Chunk.h"
+#include "Prefab.h"
+#include <array>
+#include <atomic>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
 #include <vector>
-#include <thread>
+#include <future>
+#include <functional>
+#include <string>
 #include <glm/glm.hpp>
 #include <glm/gtx/hash.hpp>
 
@@ -20,6 +25,10 @@ public:
     void Render();
     
     Chunk* GetChunk(const glm::ivec2& coord);
+    const Chunk* GetChunk(const glm::ivec2& coord) const;
+    
+    // Visit every loaded chunk; like the const GetChunk, this doesn't lock
+    void ForEachChunk(const std::function<void(const Chunk&)>& visit) const;
     Chunk* CreateChunk(const glm::ivec2& coord);
     void DestroyChunk(const glm::ivec2& coord);
     
@@ -27,18 +36,97 @@ public:
     const Particle GetParticle(int worldX, int worldY) const;
     void SetParticle(int worldX, int worldY, const Particle& particle);
     
+    // Write a prefab's masked cells with its top-left corner at the given
+    // world position, creating chunks as needed
+    void Stamp(const Prefab& prefab, const glm::ivec2& position, PrefabTransform transform = PrefabTransform::None);
+    
     void SetPlayerPosition(const glm::vec2& position);
     
+    // With streaming off, Update neither brings in chunks around the player
+    // nor drops the ones far from it; on by default
+    void SetStreamingEnabled(bool enabled) { m_StreamingEnabled = enabled; }
+    
+    // Threads that update chunks: 1 runs them one by one on the calling
+    // thread, 0 uses all of the engine-wide job system, and other counts
+    // cap how many of its threads take part. Results are the same for
+    // every count.
+    void SetUpdateThreadCount(unsigned int threadCount);
+    unsigned int GetUpdateThreadCount() const { return m_UpdateThreadCount; }
+    
+    // Simulate a freshly generated chunk on a worker for up to maxSettleTicks
+    // (or until it goes quiet) and add it to the world once it's done. If
+    // CreateChunk is asked for it first (an edit, a stamp), the chunk stops
+    // settling and joins the world right away.
+    void QueueGeneratedChunk(std::unique_ptr<Chunk> chunk, int maxSettleTicks);
+    bool IsChunkPending(const glm::ivec2& coord);
+    
+    // Run a chunk's simulation on its own until it goes quiet, maxTicks have
+    // run or *stop is set; returns the number of ticks run
+    static int SettleChunk(Chunk& chunk, int maxTicks, const std::atomic<bool>* stop = nullptr);
+    
     void Save(const std::string& directory);
     void Load(const std::string& directory);
     
+    // Load a single chunk from a save directory; returns nullptr if it isn't there
+    Chunk* LoadChunk(const std::string& directory, const glm::ivec2& coord);
+    
+    // Path of a chunk's file inside a save directory
+    static std::string ChunkFilename(const std::string& directory, const glm::ivec2& coord);
+    
+    // Generation seed a save directory was made with (see Tools/Pregen), so
+    // chunks generated next to the saved ones match them; LoadSeed returns
+    // false if the directory doesn't record one
+    static bool SaveSeed(const std::string& directory, uint32_t seed);
+    static bool LoadSeed(const std::string& directory, uint32_t& seed);
+    
+    // Chunks streamed in around the player come from this save directory
+    // when they are in it; empty turns that off
+    void SetStreamingDirectory(const std::string& directory);
+    
+    // Fills a fresh chunk. Chunks streamed in that aren't saved are made
+    // with it on a worker and settle there for up to maxSettleTicks before
+    // they join the world; without one they start out empty. It runs on
+    // several workers at once, so it must not share mutable state.
+    using ChunkGenerator = std::function<void(Chunk&)>;
+    void SetChunkGenerator(ChunkGenerator generate, int maxSettleTicks);
+    
+    // Bring in a chunk the way streaming does: load it, or queue it to be
+    // generated and settled. Does nothing if it's loaded or on its way.
+    void RequestChunk(const glm::ivec2& coord);
+    
 private:
     std::unordered_map<glm::ivec2, std::unique_ptr<Chunk>> m_Chunks;
     std::mutex m_ChunkMutex;
     
     glm::vec2 m_PlayerPosition;
     const int m_ChunkLoadRadius = 3; // Number of chunks to load around player
+    bool m_StreamingEnabled;
+    std::string m_StreamingDirectory;
+    ChunkGenerator m_ChunkGenerator;
+    int m_GeneratedSettleTicks;
+    
+    // Chunks still settling on a worker; guarded by m_ChunkMutex. Whichever
+    // of the settling job and a take-over claims the chunk first decides
+    // whether the job runs at all.
+    struct SettleControl {
+        std::atomic<bool> claimed{false};
+        std::atomic<bool> stop{false};
+    };
+    struct PendingChunk {
+        std::unique_ptr<Chunk> chunk;
+        std::shared_ptr<SettleControl> control;   // Shared with the job, which may outlive the entry
+        ChunkGenerator generate;                  // Runs before settling; empty if already filled
+        std::future<void> settled;
+    };
+    std::vector<PendingChunk> m_PendingChunks;
+    
+    void QueueChunk(std::unique_ptr<Chunk> chunk, ChunkGenerator generate, int maxSettleTicks);
+    
+    void PublishSettledChunks();
     
+    // Stop a pending chunk's settling and move it into m_Chunks; the caller
+    // holds m_ChunkMutex. Returns nullptr if nothing is pending there.
+    Chunk* TakePendingChunk(const glm::ivec2& coord);
     void UpdateChunksAroundPlayer();
     void StreamChunks();
     
@@ -47,8 +135,9 @@ private:
     
     // Multi-threading related
     void UpdateChunksMultiThreaded(float dt);
-    std::vector<std::thread> m_WorkerThreads;
     bool m_Running;
+    unsigned int m_UpdateThreadCount;
+    std::array<std::vector<Chunk*>, 4> m_PhaseChunks;  // Dirty chunks by phase, rebuilt every update
 };
 
 } // namespace Engine
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "WorldSnapshot.h"
+#include "World.h"
+#include "../Simulation/Material.h"
+#include <algorithm>
+
+namespace Engine {
+
+const uint8_t* ChunkSnapshot::GetRow(int y) const {
+    return &materials[static_cast<size_t>(y) * Chunk::CHUNK_SIZE];
+}
+
+WorldSnapshot::WorldSnapshot()
+    : m_Tick(0) {
+}
+
+const ChunkSnapshot* WorldSnapshot::GetChunk(const glm::ivec2& coord) const {
+    auto it = m_Chunks.find(coord);
+    if (it != m_Chunks.end()) {
+        return it->second.get();
+    }
+    
+    return nullptr;
+}
+
+void WorldSnapshot::ForEachChunk(const std::function<void(const ChunkSnapshot&)>& visit) const {
+    for (const auto& [coord, chunk] : m_Chunks) {
+        visit(*chunk);
+    }
+}
+
+WorldSnapshotPublisher::WorldSnapshotPublisher()
+    : m_Tick(0) {
+}
+
+void WorldSnapshotPublisher::Publish(const World& world) {
+    m_Tick++;
+    
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    const int tileSize = Chunk::RENDER_TILE_SIZE;
+    const int tilesPerRow = chunkSize / tileSize;
+    
+    // The free buffer is a few ticks old, so only tiles that changed since
+    // it was last filled need copying
+    WorldSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+    
+    // Materials that give off light, for the emissive tile masks
+    const MaterialDatabase& materials = MaterialDatabase::Get();
+    std::array<bool, 256> emissive;
+    for (int id = 0; id < 256; id++) {
+        emissive[id] = id != 0 && materials.HasMaterial(static_cast<uint8_t>(id))
+            && materials.GetMaterial(static_cast<uint8_t>(id)).emissive > 0.0f;
+    }
+    
+    world.ForEachChunk([&](const Chunk& chunk) {
+        const glm::ivec2& coord = chunk.GetCoord();
+        
+        auto [historyIt, inserted] = m_TileHistory.try_emplace(coord);
+        TileHistory& history = historyIt->second;
+        if (inserted) {
+            history.ticks.fill(m_Tick);
+        }
+        history.lastSeenTick = m_Tick;
+        
+        const uint64_t dirtyTiles = chunk.TakeRenderDirtyTiles();
+        for (int tile = 0; tile < ChunkSnapshot::TILE_COUNT; tile++) {
+            if ((dirtyTiles >> tile) & 1) {
+                history.ticks[tile] = m_Tick;
+            }
+        }
+        
+        std::unique_ptr<ChunkSnapshot>& target = snapshot.m_Chunks[coord];
+        if (!target) {
+            target = std::make_unique<ChunkSnapshot>();
+            target->coord = coord;
+            target->materials.assign(static_cast<size_t>(chunkSize) * chunkSize, 0);
+            target->tileTicks.fill(0);
+            target->changedTick = 0;
+            target->emissiveTiles = 0;
+            target->capturedTick = 0;
+        }
+        
+        for (int tile = 0; tile < ChunkSnapshot::TILE_COUNT; tile++) {
+            if (history.ticks[tile] <= target->capturedTick)
+                continue;
+            
+            const int tileX = (tile % tilesPerRow) * tileSize;
+            const int tileY = (tile / tilesPerRow) * tileSize;
+            bool hasEmitter = false;
+            for (int y = tileY; y < tileY + tileSize; y++) {
+                const Particle* cells = chunk.GetRow(y) + tileX;
+                uint8_t* out = &target->materials[static_cast<size_t>(y) * chunkSize + tileX];
+                for (int x = 0; x < tileSize; x++) {
+                    out[x] = cells[x].materialID;
+                    hasEmitter |= emissive[out[x]];
+                }
+            }
+            
+            const uint64_t tileBit = uint64_t(1) << tile;
+            target->emissiveTiles = hasEmitter ? (target->emissiveTiles | tileBit) : (target->emissiveTiles & ~tileBit);
+            target->tileTicks[tile] = history.ticks[tile];
+            target->changedTick = std::max(target->changedTick, history.ticks[tile]);
+        }
+        target->capturedTick = m_Tick;
+    });
+    
+    // Drop chunks that were unloaded since this buffer was filled
+    for (auto it = snapshot.m_Chunks.begin(); it != snapshot.m_Chunks.end();) {
+        if (it->second->capturedTick != m_Tick) {
+            it = snapshot.m_Chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    snapshot.m_Tick = m_Tick;
+    m_Snapshots.Publish();
+    
+    for (auto it = m_TileHistory.begin(); it != m_TileHistory.end();) {
+        if (it->second.lastSeenTick != m_Tick) {
+            it = m_TileHistory.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../Core/TripleBuffer.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+namespace Engine {
+
+class World;
+
+// Material plane of one chunk as of a simulation tick
+struct ChunkSnapshot {
+    static const int TILE_COUNT = 64;  // Render tiles per chunk, as in Chunk
+    
+    glm::ivec2 coord;
+    std::vector<uint8_t> materials;                 // CHUNK_SIZE x CHUNK_SIZE, row-major
+    std::array<uint64_t, TILE_COUNT> tileTicks;     // Tick each render tile last changed
+    uint64_t changedTick;                           // Newest of tileTicks
+    uint64_t emissiveTiles;                         // Tiles with an emissive cell, one bit each
+    uint64_t capturedTick;                          // Tick these contents are from
+    
+    const uint8_t* GetRow(int y) const;
+};
+
+// Read-only copy of the loaded chunks' materials, all from the same tick.
+// Renderers draw from this instead of the live World.
+class WorldSnapshot {
+public:
+    WorldSnapshot();
+    
+    uint64_t GetTick() const { return m_Tick; }
+    const ChunkSnapshot* GetChunk(const glm::ivec2& coord) const;
+    size_t GetChunkCount() const { return m_Chunks.size(); }
+    
+    // Visit every chunk in the snapshot, in no particular order
+    void ForEachChunk(const std::function<void(const ChunkSnapshot&)>& visit) const;
+    
+private:
+    friend class WorldSnapshotPublisher;
+    
+    uint64_t m_Tick;
+    std::unordered_map<glm::ivec2, std::unique_ptr<ChunkSnapshot>> m_Chunks;
+};
+
+// Publishes a snapshot of the world after every simulation tick through a
+// triple buffer, so the render thread never has to lock or wait for World.
+// Publish is called from the simulation thread only, and AcquireLatest and
+// GetLatest from the render thread only.
+class WorldSnapshotPublisher {
+public:
+    WorldSnapshotPublisher();
+    
+    // Capture the loaded chunks into the free snapshot and publish it. Only
+    // tiles that changed since that snapshot was last filled are copied.
+    void Publish(const World& world);
+    
+    // Switch to the newest published snapshot; false if there is none newer
+    bool AcquireLatest() { return m_Snapshots.Acquire(); }
+    const WorldSnapshot& GetLatest() const { return m_Snapshots.GetReadBuffer(); }
+    
+private:
+    // Simulation-side record of when each tile of each chunk last changed
+    struct TileHistory {
+        std::array<uint64_t, ChunkSnapshot::TILE_COUNT> ticks;
+        uint64_t lastSeenTick;
+    };
+    
+    TripleBuffer<WorldSnapshot> m_Snapshots;
+    std::unordered_map<glm::ivec2, TileHistory> m_TileHistory;
+    uint64_t m_Tick;
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+// Weight of the newest frame in the smoothed frame time
+static const float SMOOTHING = 0.25f;
+
+// Above this share of the budget the scale drops; below the lower one it may rise
+static const float UPPER_THRESHOLD = 1.0f;
+static const float LOWER_THRESHOLD = 0.7f;
+
+// Dropping aims a little under budget, so the next frames have headroom
+static const float DROP_TARGET = 0.85f;
+static const float MAX_DROP = 0.2f;
+
+// Rising waits for this many good frames and then takes a small step
+static const int RAISE_DELAY = 30;
+static const float RAISE_STEP = 0.05f;
+
+// Frames recorded before a change are still measured afterwards; the
+// renderer reads timestamps two frames late
+static const int SETTLE_FRAMES = 3;
+
+DynamicResolution::DynamicResolution(float budgetMs)
+    : m_budget(budgetMs)
+    , m_scale(MAX_SCALE)
+    , m_average(0.0f)
+    , m_settleFrames(0)
+    , m_underBudgetFrames(0) {
+}
+
+float DynamicResolution::addFrameTime(float frameMs) {
+    if (m_settleFrames > 0) {
+        m_settleFrames--;
+        return m_scale;
+    }
+    
+    m_average = m_average > 0.0f ? m_average + (frameMs - m_average) * SMOOTHING : frameMs;
+    
+    float scale = m_scale;
+    if (m_average > m_budget * UPPER_THRESHOLD) {
+        // Fill cost goes with the pixel count, the square of the scale
+        const float target = m_scale * std::sqrt(m_budget * DROP_TARGET / m_average);
+        scale = std::max(MIN_SCALE, std::max(target, m_scale - MAX_DROP));
+        m_underBudgetFrames = 0;
+    } else if (m_average < m_budget * LOWER_THRESHOLD) {
+        if (++m_underBudgetFrames >= RAISE_DELAY) {
+            scale = std::min(MAX_SCALE, m_scale + RAISE_STEP);
+            m_underBudgetFrames = 0;
+        }
+    } else {
+        m_underBudgetFrames = 0;
+    }
+    
+    if (scale != m_scale) {
+        m_scale = scale;
+        m_average = 0.0f;
+        m_settleFrames = SETTLE_FRAMES;
+    }
+    return m_scale;
+}
+
+void DynamicResolution::reset() {
+    m_scale = MAX_SCALE;
+    m_average = 0.0f;
+    m_settleFrames = 0;
+    m_underBudgetFrames = 0;
+}
+
+} // namespace Engine
\ No newline at end of file
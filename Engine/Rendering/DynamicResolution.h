@@ -0,0 +1,34 @@
+#pragma once
+
+namespace Engine {
+
+// Picks the scale the world is drawn at from recent GPU frame times. Over
+// budget, the scale drops at once by about as much as the frames are too
+// slow; only after a run of frames well under budget does it creep back
+// up, one small step at a time, so it settles instead of oscillating.
+class DynamicResolution {
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.0f;
+    
+    explicit DynamicResolution(float budgetMs = 14.0f);
+    
+    void setBudget(float budgetMs) { m_budget = budgetMs; }
+    float getBudget() const { return m_budget; }
+    
+    // Feed the GPU time of a finished frame; returns the scale for the next one
+    float addFrameTime(float frameMs);
+    float getScale() const { return m_scale; }
+    
+    // Back to full resolution, forgetting past frames
+    void reset();
+    
+private:
+    float m_budget;
+    float m_scale;
+    float m_average;          // Smoothed frame time since the last change; 0 = none yet
+    int m_settleFrames;       // Frames still in flight at the old scale
+    int m_underBudgetFrames;  // Consecutive frames well under budget
+};
+
+} // namespace Engine
\ No newline at end of file
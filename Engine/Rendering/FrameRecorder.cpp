@@ -0,0 +1,302 @@
+#include "FrameRecorder.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Engine {
+
+static const uint8_t PNG_SIGNATURE[8] = { 137, 'P', 'N', 'G', 13, 10, 26, 10 };
+
+// Largest stored deflate block
+static const size_t STORED_BLOCK_SIZE = 65535;
+
+static uint32_t Crc32(const uint8_t* data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+    
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static uint32_t Adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+static void PutBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Start a PNG chunk; returns where its length goes, for EndChunk
+static size_t BeginChunk(std::vector<uint8_t>& out, const char* type) {
+    const size_t start = out.size();
+    PutBigEndian(out, 0);
+    out.insert(out.end(), type, type + 4);
+    return start;
+}
+
+static void EndChunk(std::vector<uint8_t>& out, size_t start) {
+    const uint32_t length = static_cast<uint32_t>(out.size() - start - 8);
+    for (int i = 0; i < 4; i++) {
+        out[start + i] = static_cast<uint8_t>(length >> (24 - 8 * i));
+    }
+    
+    // The CRC covers the type and the data
+    PutBigEndian(out, Crc32(&out[start + 4], length + 4));
+}
+
+// Pixel row as R, G, B
+static void ConvertRow(const CapturedFrame& frame, int y, uint8_t* out) {
+    const uint8_t* pixels = &frame.pixels[static_cast<size_t>(y) * frame.width * 4];
+    const int red = frame.bgra ? 2 : 0;
+    const int blue = frame.bgra ? 0 : 2;
+    for (int x = 0; x < frame.width; x++) {
+        out[x * 3 + 0] = pixels[x * 4 + red];
+        out[x * 3 + 1] = pixels[x * 4 + 1];
+        out[x * 3 + 2] = pixels[x * 4 + blue];
+    }
+}
+
+static bool WriteFile(const std::string& filename, const std::vector<uint8_t>& data) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for recording: " << filename << std::endl;
+        return false;
+    }
+    
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return file.good();
+}
+
+FrameRecorder::FrameRecorder()
+    : m_stopping(false)
+    , m_format(CaptureFormat::PPM)
+    , m_dumpMaterials(false)
+    , m_recording(false)
+    , m_nextIndex(0)
+    , m_writtenCount(0)
+    , m_droppedCount(0) {
+}
+
+FrameRecorder::~FrameRecorder() {
+    stop();
+}
+
+bool FrameRecorder::start(const std::string& directory, CaptureFormat format, bool dumpMaterials) {
+    stop();
+    
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create recording directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    
+    m_directory = directory;
+    m_format = format;
+    m_dumpMaterials = dumpMaterials;
+    m_nextIndex = 0;
+    m_writtenCount = 0;
+    m_droppedCount = 0;
+    
+    if (m_frames.empty()) {
+        for (int i = 0; i < POOL_SIZE; i++) {
+            m_frames.push_back(std::make_unique<CapturedFrame>());
+            m_freeFrames.push_back(m_frames.back().get());
+        }
+    }
+    
+    m_stopping = false;
+    m_writer = std::thread(&FrameRecorder::writerLoop, this);
+    m_recording = true;
+    
+    std::cout << "Recording frames to " << directory << std::endl;
+    return true;
+}
+
+void FrameRecorder::stop() {
+    if (!m_recording)
+        return;
+    m_recording = false;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_queueReady.notify_all();
+    m_writer.join();
+    
+    std::cout << "Recording stopped: " << m_writtenCount << " frames written, "
+              << m_droppedCount << " dropped" << std::endl;
+}
+
+CapturedFrame* FrameRecorder::acquireFrame() {
+    if (!m_recording)
+        return nullptr;
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t index = m_nextIndex++;
+    if (m_freeFrames.empty()) {
+        m_droppedCount++;
+        return nullptr;
+    }
+    
+    CapturedFrame* frame = m_freeFrames.back();
+    m_freeFrames.pop_back();
+    frame->index = index;
+    frame->width = 0;
+    frame->height = 0;
+    frame->bgra = false;
+    frame->materialWidth = 0;
+    frame->materialHeight = 0;
+    frame->materials.clear();
+    return frame;
+}
+
+void FrameRecorder::submitFrame(CapturedFrame* frame) {
+    // Frames still in flight when recording stopped are just returned
+    if (!m_recording) {
+        releaseFrame(frame);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(frame);
+    }
+    m_queueReady.notify_one();
+}
+
+void FrameRecorder::releaseFrame(CapturedFrame* frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_freeFrames.push_back(frame);
+}
+
+void FrameRecorder::writerLoop() {
+    for (;;) {
+        CapturedFrame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueReady.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            
+            // Stopping only ends the loop once the queue has drained
+            if (m_queue.empty())
+                return;
+            
+            frame = m_queue.front();
+            m_queue.pop_front();
+        }
+        
+        bool written = writeFrame(*frame);
+        if (written && !frame->materials.empty()) {
+            written = writeMaterials(*frame);
+        }
+        if (written) {
+            m_writtenCount++;
+        }
+        
+        releaseFrame(frame);
+    }
+}
+
+bool FrameRecorder::writeFrame(const CapturedFrame& frame) {
+    if (frame.width <= 0 || frame.height <= 0)
+        return false;
+    
+    const size_t rowSize = static_cast<size_t>(frame.width) * 3;
+    m_encoded.clear();
+    
+    char name[32];
+    if (m_format == CaptureFormat::PPM) {
+        std::snprintf(name, sizeof(name), "frame_%06llu.ppm", static_cast<unsigned long long>(frame.index));
+        
+        const std::string header = "P6\n" + std::to_string(frame.width) + " " + std::to_string(frame.height) + "\n255\n";
+        m_encoded.assign(header.begin(), header.end());
+        m_encoded.resize(header.size() + rowSize * frame.height);
+        for (int y = 0; y < frame.height; y++) {
+            ConvertRow(frame, y, &m_encoded[header.size() + rowSize * y]);
+        }
+    } else {
+        std::snprintf(name, sizeof(name), "frame_%06llu.png", static_cast<unsigned long long>(frame.index));
+        
+        // Scanlines without filtering, each led by its filter type (0)
+        m_scanlines.resize((rowSize + 1) * frame.height);
+        for (int y = 0; y < frame.height; y++) {
+            uint8_t* row = &m_scanlines[(rowSize + 1) * y];
+            row[0] = 0;
+            ConvertRow(frame, y, row + 1);
+        }
+        
+        m_encoded.insert(m_encoded.end(), PNG_SIGNATURE, PNG_SIGNATURE + 8);
+        
+        size_t chunk = BeginChunk(m_encoded, "IHDR");
+        PutBigEndian(m_encoded, static_cast<uint32_t>(frame.width));
+        PutBigEndian(m_encoded, static_cast<uint32_t>(frame.height));
+        m_encoded.push_back(8);  // Bit depth
+        m_encoded.push_back(2);  // Truecolor
+        m_encoded.push_back(0);  // Deflate
+        m_encoded.push_back(0);  // Adaptive filtering
+        m_encoded.push_back(0);  // Not interlaced
+        EndChunk(m_encoded, chunk);
+        
+        // A zlib stream of stored blocks: no compression, so encoding is
+        // about as cheap as PPM, but the files open anywhere
+        chunk = BeginChunk(m_encoded, "IDAT");
+        m_encoded.push_back(0x78);
+        m_encoded.push_back(0x01);
+        size_t offset = 0;
+        do {
+            const size_t blockSize = std::min(STORED_BLOCK_SIZE, m_scanlines.size() - offset);
+            const bool lastBlock = offset + blockSize == m_scanlines.size();
+            m_encoded.push_back(lastBlock ? 1 : 0);
+            m_encoded.push_back(static_cast<uint8_t>(blockSize));
+            m_encoded.push_back(static_cast<uint8_t>(blockSize >> 8));
+            m_encoded.push_back(static_cast<uint8_t>(~blockSize));
+            m_encoded.push_back(static_cast<uint8_t>(~blockSize >> 8));
+            m_encoded.insert(m_encoded.end(), m_scanlines.begin() + offset, m_scanlines.begin() + offset + blockSize);
+            offset += blockSize;
+        } while (offset < m_scanlines.size());
+        PutBigEndian(m_encoded, Adler32(m_scanlines.data(), m_scanlines.size()));
+        EndChunk(m_encoded, chunk);
+        
+        EndChunk(m_encoded, BeginChunk(m_encoded, "IEND"));
+    }
+    
+    return WriteFile((std::filesystem::path(m_directory) / name).string(), m_encoded);
+}
+
+bool FrameRecorder::writeMaterials(const CapturedFrame& frame) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "materials_%06llu.pgm", static_cast<unsigned long long>(frame.index));
+    
+    // One byte per cell: the material ID, as a grayscale image
+    const std::string header = "P5\n" + std::to_string(frame.materialWidth) + " " + std::to_string(frame.materialHeight) + "\n255\n";
+    m_encoded.assign(header.begin(), header.end());
+    m_encoded.insert(m_encoded.end(), frame.materials.begin(), frame.materials.end());
+    
+    return WriteFile((std::filesystem::path(m_directory) / name).string(), m_encoded);
+}
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Engine {
+
+enum class CaptureFormat {
+    PPM,
+    PNG
+};
+
+// One recorded frame. Frames come from a pool and keep their buffers, so
+// recording doesn't allocate once the pool has seen the frame size.
+struct CapturedFrame {
+    uint64_t index;                  // Frame number, used in the file names
+    int width;
+    int height;
+    bool bgra;                       // Pixels are B, G, R, A in memory instead of R, G, B, A
+    std::vector<uint8_t> pixels;     // width x height x 4, top row first
+    int materialWidth;
+    int materialHeight;
+    std::vector<uint8_t> materials;  // Material IDs of the cells in view; empty unless dumped
+};
+
+// Writes recorded frames on a background thread. The render thread fills a
+// frame from a small pool and submits it; the writer encodes it, writes it
+// and returns it to the pool. When the writer falls behind and the pool
+// runs dry, new frames are dropped instead of waited for, so recording
+// never stalls the frame loop. Dropped frames leave gaps in the numbering.
+class FrameRecorder {
+public:
+    static constexpr int POOL_SIZE = 4;
+    
+    FrameRecorder();
+    ~FrameRecorder();
+    
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+    
+    // Start writing frames into the directory; with dumpMaterials, each
+    // frame also gets a PGM of the material IDs in view
+    bool start(const std::string& directory, CaptureFormat format, bool dumpMaterials);
+    
+    // Finish writing the frames already submitted, then stop
+    void stop();
+    
+    bool isRecording() const { return m_recording; }
+    bool dumpsMaterials() const { return m_dumpMaterials; }
+    
+    // Render thread: a free frame to fill, or nullptr (counted as dropped)
+    // when every frame is still queued. An acquired frame must be handed
+    // back through submitFrame or releaseFrame.
+    CapturedFrame* acquireFrame();
+    void submitFrame(CapturedFrame* frame);
+    void releaseFrame(CapturedFrame* frame);
+    
+    uint64_t getWrittenCount() const { return m_writtenCount; }
+    uint64_t getDroppedCount() const { return m_droppedCount; }
+    
+private:
+    std::vector<std::unique_ptr<CapturedFrame>> m_frames;
+    std::vector<CapturedFrame*> m_freeFrames;
+    std::deque<CapturedFrame*> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_queueReady;
+    std::thread m_writer;
+    bool m_stopping;
+    
+    // Settings of the current recording; only changed while the writer is stopped
+    std::string m_directory;
+    CaptureFormat m_format;
+    bool m_dumpMaterials;
+    bool m_recording;
+    
+    uint64_t m_nextIndex;
+    std::atomic<uint64_t> m_writtenCount;
+    std::atomic<uint64_t> m_droppedCount;
+    
+    // Encoder scratch, only touched by the writer
+    std::vector<uint8_t> m_encoded;
+    std::vector<uint8_t> m_scanlines;
+    
+    void writerLoop();
+    bool writeFrame(const CapturedFrame& frame);
+    bool writeMaterials(const CapturedFrame& frame);
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "LightMap.h"
+#include "../Procedural/WorldSnapshot.h"
+#include "../Procedural/Chunk.h"
+#include "../Simulation/Material.h"
+#include "../Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define LIGHTMAP_USE_SSE 1
+#endif
+
+namespace Engine {
+
+// Brightness of the blurred light; a full 3x3 texel patch of fire comes close to 1
+static const float LIGHT_GAIN = 8.0f;
+
+// Floor division, so negative cells land in the chunk to their left
+static int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// out[i] += in[i] * weight; every blur tap is one of these over a block row
+static void AddWeightedRow(float* out, const float* in, float weight, int count) {
+    int i = 0;
+#ifdef LIGHTMAP_USE_SSE
+    const __m128 weights = _mm_set1_ps(weight);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), weights)));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] += in[i] * weight;
+    }
+}
+
+static uint8_t ToByte(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+LightMap::LightMap()
+    : m_origin(0, 0)
+    , m_hasOrigin(false)
+    , m_fullyChanged(true)
+    , m_lastTick(0) {
+    
+    m_strength.fill(0.0f);
+    
+    // Gaussian taps reaching RADIUS texels to each side, normalized
+    const float sigma = RADIUS / 2.0f;
+    float total = 0.0f;
+    for (int offset = -RADIUS; offset <= RADIUS; offset++) {
+        m_weights[offset + RADIUS] = std::exp(-(offset * offset) / (2.0f * sigma * sigma));
+        total += m_weights[offset + RADIUS];
+    }
+    for (float& weight : m_weights) {
+        weight /= total;
+    }
+    m_emission.assign(static_cast<size_t>(PADDED_SIZE) * PADDED_SIZE, 0.0f);
+    m_spread.assign(static_cast<size_t>(PADDED_SIZE) * PADDED_SIZE, 0.0f);
+    m_texels.assign(static_cast<size_t>(SIZE) * SIZE, 0);
+    
+    m_emitting.assign(PADDED_BLOCKS * PADDED_BLOCKS, 0);
+    m_wasEmitting.assign(PADDED_BLOCKS * PADDED_BLOCKS, 0);
+    m_spreading.assign(PADDED_BLOCKS * PADDED_BLOCKS, 0);
+    m_wasSpreading.assign(PADDED_BLOCKS * PADDED_BLOCKS, 0);
+    m_lit.assign(BLOCKS_PER_SIDE * BLOCKS_PER_SIDE, 0);
+    m_wasLit.assign(BLOCKS_PER_SIDE * BLOCKS_PER_SIDE, 0);
+}
+
+void LightMap::update(const WorldSnapshot& snapshot, int cameraX, int cameraY) {
+    const glm::ivec2 origin(
+        FloorDiv(cameraX, Chunk::CHUNK_SIZE) - BLOCKS_PER_SIDE / 2,
+        FloorDiv(cameraY, Chunk::CHUNK_SIZE) - BLOCKS_PER_SIDE / 2
+    );
+    m_fullyChanged = !m_hasOrigin || origin != m_origin;
+    
+    // Most frames see no new simulation tick, and the map is still current
+    if (!m_fullyChanged && snapshot.GetTick() == m_lastTick) {
+        m_changedBlocks.clear();
+        return;
+    }
+    m_lastTick = snapshot.GetTick();
+    
+    const MaterialDatabase& materials = MaterialDatabase::Get();
+    for (int id = 0; id < 256; id++) {
+        const bool known = id != 0 && materials.HasMaterial(static_cast<uint8_t>(id));
+        m_strength[id] = known ? materials.GetMaterial(static_cast<uint8_t>(id)).emissive : 0.0f;
+    }
+    
+    m_emitting.swap(m_wasEmitting);
+    m_spreading.swap(m_wasSpreading);
+    m_lit.swap(m_wasLit);
+    
+    if (m_fullyChanged) {
+        moveWindow(origin);
+    }
+    
+    // Each pass writes only its own block rows; the next pass reads the
+    // rows around them, so the passes run one after another
+    JobSystem& jobs = JobSystem::Get();
+    jobs.ParallelFor(0, PADDED_BLOCKS, [&](int row) { emitBlockRow(snapshot, row); });
+    jobs.ParallelFor(0, PADDED_BLOCKS, [&](int row) { spreadBlockRow(row); });
+    jobs.ParallelFor(0, BLOCKS_PER_SIDE, [&](int row) { gatherBlockRow(row); });
+    
+    m_changedBlocks.clear();
+    if (!m_fullyChanged) {
+        for (int block = 0; block < BLOCKS_PER_SIDE * BLOCKS_PER_SIDE; block++) {
+            if (m_lit[block] || m_wasLit[block]) {
+                m_changedBlocks.push_back(block);
+            }
+        }
+    }
+}
+
+void LightMap::moveWindow(const glm::ivec2& origin) {
+    m_origin = origin;
+    m_hasOrigin = true;
+    
+    // Nothing carries over; start from darkness
+    std::fill(m_emission.begin(), m_emission.end(), 0.0f);
+    std::fill(m_spread.begin(), m_spread.end(), 0.0f);
+    std::fill(m_texels.begin(), m_texels.end(), 0);
+    std::fill(m_wasEmitting.begin(), m_wasEmitting.end(), 0);
+    std::fill(m_wasSpreading.begin(), m_wasSpreading.end(), 0);
+    std::fill(m_wasLit.begin(), m_wasLit.end(), 0);
+}
+
+void LightMap::emitBlockRow(const WorldSnapshot& snapshot, int paddedBlockY) {
+    const int tileSize = Chunk::RENDER_TILE_SIZE;
+    const int tilesPerRow = Chunk::CHUNK_SIZE / tileSize;
+    const int texelsPerTile = tileSize / CELLS_PER_TEXEL;
+    const float cellWeight = 1.0f / (CELLS_PER_TEXEL * CELLS_PER_TEXEL);
+    
+    for (int paddedBlockX = 0; paddedBlockX < PADDED_BLOCKS; paddedBlockX++) {
+        const int block = paddedBlockY * PADDED_BLOCKS + paddedBlockX;
+        float* blockTexels = &m_emission[static_cast<size_t>(paddedBlockY) * BLOCK_SIZE * PADDED_SIZE + paddedBlockX * BLOCK_SIZE];
+        
+        if (m_wasEmitting[block]) {
+            for (int row = 0; row < BLOCK_SIZE; row++) {
+                std::fill(blockTexels + row * PADDED_SIZE, blockTexels + row * PADDED_SIZE + BLOCK_SIZE, 0.0f);
+            }
+        }
+        
+        const ChunkSnapshot* chunk = snapshot.GetChunk(m_origin + glm::ivec2(paddedBlockX - 1, paddedBlockY - 1));
+        const uint64_t emissiveTiles = chunk ? chunk->emissiveTiles : 0;
+        m_emitting[block] = emissiveTiles != 0;
+        
+        // Only tiles holding an emitter are averaged; the rest stay dark
+        for (int tile = 0; tile < ChunkSnapshot::TILE_COUNT; tile++) {
+            if (!((emissiveTiles >> tile) & 1))
+                continue;
+            
+            const int tileX = tile % tilesPerRow;
+            const int tileY = tile / tilesPerRow;
+            for (int texelY = 0; texelY < texelsPerTile; texelY++) {
+                for (int texelX = 0; texelX < texelsPerTile; texelX++) {
+                    const int cellX = tileX * tileSize + texelX * CELLS_PER_TEXEL;
+                    const int cellY = tileY * tileSize + texelY * CELLS_PER_TEXEL;
+                    
+                    float sum = 0.0f;
+                    for (int y = cellY; y < cellY + CELLS_PER_TEXEL; y++) {
+                        const uint8_t* cells = chunk->GetRow(y) + cellX;
+                        for (int x = 0; x < CELLS_PER_TEXEL; x++) {
+                            sum += m_strength[cells[x]];
+                        }
+                    }
+                    
+                    const int row = tileY * texelsPerTile + texelY;
+                    const int column = tileX * texelsPerTile + texelX;
+                    blockTexels[row * PADDED_SIZE + column] = sum * cellWeight;
+                }
+            }
+        }
+    }
+}
+
+void LightMap::spreadBlockRow(int paddedBlockY) {
+    // Horizontal pass over the window's columns; a block only picks up light
+    // from itself and its left and right neighbors
+    for (int blockX = 0; blockX < BLOCKS_PER_SIDE; blockX++) {
+        const int paddedBlockX = blockX + 1;
+        const int block = paddedBlockY * PADDED_BLOCKS + paddedBlockX;
+        const bool active = m_emitting[block - 1] || m_emitting[block] || m_emitting[block + 1];
+        m_spreading[block] = active;
+        
+        if (!active && !m_wasSpreading[block])
+            continue;
+        
+        for (int row = 0; row < BLOCK_SIZE; row++) {
+            const size_t start = static_cast<size_t>(paddedBlockY * BLOCK_SIZE + row) * PADDED_SIZE + paddedBlockX * BLOCK_SIZE;
+            float* out = &m_spread[start];
+            std::fill(out, out + BLOCK_SIZE, 0.0f);
+            
+            if (!active)
+                continue;
+            
+            const float* in = &m_emission[start];
+            for (int offset = -RADIUS; offset <= RADIUS; offset++) {
+                AddWeightedRow(out, in + offset, m_weights[offset + RADIUS], BLOCK_SIZE);
+            }
+        }
+    }
+}
+
+void LightMap::gatherBlockRow(int blockY) {
+    const int paddedBlockY = blockY + 1;
+    
+    // Vertical pass, from the horizontal results of the blocks above and below
+    for (int blockX = 0; blockX < BLOCKS_PER_SIDE; blockX++) {
+        const int paddedBlockX = blockX + 1;
+        const int paddedBlock = paddedBlockY * PADDED_BLOCKS + paddedBlockX;
+        const bool active = m_spreading[paddedBlock - PADDED_BLOCKS] || m_spreading[paddedBlock]
+            || m_spreading[paddedBlock + PADDED_BLOCKS];
+        
+        const int block = blockY * BLOCKS_PER_SIDE + blockX;
+        m_lit[block] = active;
+        
+        if (!active && !m_wasLit[block])
+            continue;
+        
+        for (int row = 0; row < BLOCK_SIZE; row++) {
+            uint8_t* out = &m_texels[static_cast<size_t>(blockY * BLOCK_SIZE + row) * SIZE + blockX * BLOCK_SIZE];
+            if (!active) {
+                std::memset(out, 0, BLOCK_SIZE);
+                continue;
+            }
+            
+            float sum[BLOCK_SIZE] = {};
+            const float* in = &m_spread[static_cast<size_t>(paddedBlockY * BLOCK_SIZE + row) * PADDED_SIZE + paddedBlockX * BLOCK_SIZE];
+            for (int offset = -RADIUS; offset <= RADIUS; offset++) {
+                AddWeightedRow(sum, in + offset * PADDED_SIZE, m_weights[offset + RADIUS], BLOCK_SIZE);
+            }
+            
+            for (int i = 0; i < BLOCK_SIZE; i++) {
+                out[i] = ToByte(sum[i] * LIGHT_GAIN);
+            }
+        }
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+// Forward declarations
+class WorldSnapshot;
+
+// Light given off by emissive materials, for a window of chunks around the
+// camera at a quarter of the cell resolution. Emitting tiles are averaged
+// into the map and spread with a separable Gaussian blur on the job system.
+// Blocks with no emitter within reach are skipped, so the cost follows the
+// amount of fire in view, not the screen resolution.
+class LightMap {
+public:
+    static constexpr int CELLS_PER_TEXEL = 4;
+    static constexpr int BLOCK_SIZE = 16;                          // Texels per chunk side
+    static constexpr int BLOCKS_PER_SIDE = 32;                     // Chunks per window side
+    static constexpr int SIZE = BLOCK_SIZE * BLOCKS_PER_SIDE;      // Texels per window side
+    static constexpr int RADIUS = 6;                               // Blur reach in texels; at most BLOCK_SIZE
+    
+    LightMap();
+    
+    // Recompute the window around the given cell from the snapshot; does
+    // nothing unless the snapshot has a new tick or the window moved
+    void update(const WorldSnapshot& snapshot, int cameraX, int cameraY);
+    
+    // Chunk under texel (0, 0)
+    const glm::ivec2& getOrigin() const { return m_origin; }
+    
+    // Light intensity, SIZE x SIZE bytes, top row first
+    const std::vector<uint8_t>& getTexels() const { return m_texels; }
+    
+    // Blocks whose texels changed in the last update, as by * BLOCKS_PER_SIDE
+    // + bx; when the window moved, every texel changed instead
+    const std::vector<int>& getChangedBlocks() const { return m_changedBlocks; }
+    bool isFullyChanged() const { return m_fullyChanged; }
+    
+private:
+    // Emission and the horizontal pass keep a ring of one block around the
+    // window, so emitters just outside it still light its edges
+    static constexpr int PADDED_BLOCKS = BLOCKS_PER_SIDE + 2;
+    static constexpr int PADDED_SIZE = PADDED_BLOCKS * BLOCK_SIZE;
+    
+    glm::ivec2 m_origin;
+    bool m_hasOrigin;
+    bool m_fullyChanged;
+    uint64_t m_lastTick;   // Snapshot tick of the last update
+    
+    std::array<float, 256> m_strength;  // Emission of each material
+    std::array<float, 2 * RADIUS + 1> m_weights;  // Blur taps, center at RADIUS
+    
+    std::vector<float> m_emission;      // PADDED_SIZE squared
+    std::vector<float> m_spread;        // After the horizontal pass, PADDED_SIZE squared
+    std::vector<uint8_t> m_texels;      // After the vertical pass, SIZE squared
+    
+    // Per-block state, this update and the one before; anything that was
+    // written last time but isn't now has to be cleared
+    std::vector<uint8_t> m_emitting, m_wasEmitting;   // Padded grid
+    std::vector<uint8_t> m_spreading, m_wasSpreading; // Padded grid
+    std::vector<uint8_t> m_lit, m_wasLit;             // Window grid
+    std::vector<int> m_changedBlocks;
+    
+    void moveWindow(const glm::ivec2& origin);
+    void emitBlockRow(const WorldSnapshot& snapshot, int paddedBlockY);
+    void spreadBlockRow(int paddedBlockY);
+    void gatherBlockRow(int blockY);
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "Minimap.h"
+#include "../Procedural/WorldSnapshot.h"
+#include "../Procedural/Chunk.h"
+#include <cstring>
+
+namespace Engine {
+
+// Floor division, so negative cells land in the chunk to their left
+static int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// Block of the window texture a chunk lives in
+static int BlockOf(const glm::ivec2& coord) {
+    const int mask = Minimap::CHUNKS_PER_SIDE - 1;
+    return (coord.y & mask) * Minimap::CHUNKS_PER_SIDE + (coord.x & mask);
+}
+
+Minimap::Minimap()
+    : m_origin(0, 0)
+    , m_hasOrigin(false)
+    , m_fullyChanged(true)
+    , m_lastTick(0) {
+    
+    m_texels.assign(static_cast<size_t>(SIZE) * SIZE, 0);
+    m_blockChanged.assign(CHUNKS_PER_SIDE * CHUNKS_PER_SIDE, 0);
+    m_counts.fill(0);
+}
+
+void Minimap::update(const WorldSnapshot& snapshot, int cameraX, int cameraY) {
+    m_changedBlocks.clear();
+    
+    const glm::ivec2 origin(
+        FloorDiv(cameraX, Chunk::CHUNK_SIZE) - CHUNKS_PER_SIDE / 2,
+        FloorDiv(cameraY, Chunk::CHUNK_SIZE) - CHUNKS_PER_SIDE / 2
+    );
+    m_fullyChanged = !m_hasOrigin;
+    if (!m_hasOrigin || origin != m_origin) {
+        moveWindow(origin);
+    }
+    
+    // Most frames see no new simulation tick and stop here
+    if (snapshot.GetTick() != m_lastTick) {
+        m_lastTick = snapshot.GetTick();
+        
+        snapshot.ForEachChunk([&](const ChunkSnapshot& chunk) {
+            auto [it, inserted] = m_summaries.try_emplace(chunk.coord);
+            ChunkSummary& summary = it->second;
+            if (!inserted && chunk.changedTick <= summary.tick)
+                return;
+            
+            const bool changed = summarize(chunk, summary, inserted);
+            const glm::ivec2 windowCoord = chunk.coord - m_origin;
+            if (changed && windowCoord.x >= 0 && windowCoord.y >= 0 &&
+                windowCoord.x < CHUNKS_PER_SIDE && windowCoord.y < CHUNKS_PER_SIDE) {
+                writeBlock(chunk.coord, &summary);
+            }
+        });
+    }
+    
+    for (int block : m_changedBlocks) {
+        m_blockChanged[block] = 0;
+    }
+    if (m_fullyChanged) {
+        m_changedBlocks.clear();
+    }
+}
+
+void Minimap::moveWindow(const glm::ivec2& origin) {
+    const glm::ivec2 oldOrigin = m_origin;
+    const bool hadOrigin = m_hasOrigin;
+    m_origin = origin;
+    m_hasOrigin = true;
+    
+    // Only chunks that just came into the window need their blocks written;
+    // the others are still in place
+    for (int y = 0; y < CHUNKS_PER_SIDE; y++) {
+        for (int x = 0; x < CHUNKS_PER_SIDE; x++) {
+            const glm::ivec2 coord = origin + glm::ivec2(x, y);
+            const glm::ivec2 oldCoord = coord - oldOrigin;
+            if (hadOrigin && oldCoord.x >= 0 && oldCoord.y >= 0 &&
+                oldCoord.x < CHUNKS_PER_SIDE && oldCoord.y < CHUNKS_PER_SIDE)
+                continue;
+            
+            auto it = m_summaries.find(coord);
+            writeBlock(coord, it != m_summaries.end() ? &it->second : nullptr);
+        }
+    }
+}
+
+bool Minimap::summarize(const ChunkSnapshot& chunk, ChunkSummary& summary, bool whole) {
+    const int tileSize = Chunk::RENDER_TILE_SIZE;
+    bool changed = false;
+    
+    for (int tile = 0; tile < ChunkSnapshot::TILE_COUNT; tile++) {
+        if (!whole && chunk.tileTicks[tile] <= summary.tick)
+            continue;
+        
+        // Most common material of the tile's cells; a tie goes to the one that got there first
+        const int tileX = (tile % TEXELS_PER_CHUNK) * tileSize;
+        const int tileY = (tile / TEXELS_PER_CHUNK) * tileSize;
+        uint8_t best = 0;
+        uint8_t bestCount = 0;
+        for (int y = tileY; y < tileY + tileSize; y++) {
+            const uint8_t* cells = chunk.GetRow(y) + tileX;
+            for (int x = 0; x < tileSize; x++) {
+                const uint8_t count = ++m_counts[cells[x]];
+                if (count > bestCount) {
+                    bestCount = count;
+                    best = cells[x];
+                }
+            }
+        }
+        for (int y = tileY; y < tileY + tileSize; y++) {
+            const uint8_t* cells = chunk.GetRow(y) + tileX;
+            for (int x = 0; x < tileSize; x++) {
+                m_counts[cells[x]] = 0;
+            }
+        }
+        
+        changed |= whole || summary.texels[tile] != best;
+        summary.texels[tile] = best;
+    }
+    
+    summary.tick = chunk.capturedTick;
+    return changed;
+}
+
+void Minimap::writeBlock(const glm::ivec2& coord, const ChunkSummary* summary) {
+    const int block = BlockOf(coord);
+    const int blockX = block % CHUNKS_PER_SIDE;
+    const int blockY = block / CHUNKS_PER_SIDE;
+    
+    // Unknown chunks are left empty
+    for (int row = 0; row < TEXELS_PER_CHUNK; row++) {
+        uint8_t* out = &m_texels[static_cast<size_t>(blockY * TEXELS_PER_CHUNK + row) * SIZE + blockX * TEXELS_PER_CHUNK];
+        if (summary) {
+            std::memcpy(out, &summary->texels[row * TEXELS_PER_CHUNK], TEXELS_PER_CHUNK);
+        } else {
+            std::memset(out, 0, TEXELS_PER_CHUNK);
+        }
+    }
+    
+    if (!m_blockChanged[block]) {
+        m_blockChanged[block] = 1;
+        m_changedBlocks.push_back(block);
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
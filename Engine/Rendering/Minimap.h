@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+namespace Engine {
+
+// Forward declarations
+class WorldSnapshot;
+struct ChunkSnapshot;
+
+// Overview of a wide window of chunks around the camera, one texel per
+// render tile (8x8 cells) holding the tile's most common material. Every
+// chunk the snapshot shows is summarized, and only the tiles whose tick
+// moved are summarized again. Summaries outlive their chunks, so areas that
+// were unloaded stay on the map as they were last seen.
+class Minimap {
+public:
+    static constexpr int TEXELS_PER_CHUNK = 8;                          // Render tiles per chunk side
+    static constexpr int CHUNKS_PER_SIDE = 64;                          // Chunks per window side
+    static constexpr int SIZE = TEXELS_PER_CHUNK * CHUNKS_PER_SIDE;     // Texels per window side
+    
+    Minimap();
+    
+    // Move the window to the given cell and take in the snapshot's changes
+    void update(const WorldSnapshot& snapshot, int cameraX, int cameraY);
+    
+    // First chunk of the window. The texels wrap around: chunk c is in the
+    // block at c mod CHUNKS_PER_SIDE, so a pan only rewrites the chunks it
+    // exposes.
+    const glm::ivec2& getOrigin() const { return m_origin; }
+    
+    // Material IDs, SIZE x SIZE bytes
+    const std::vector<uint8_t>& getTexels() const { return m_texels; }
+    
+    // Blocks whose texels changed in the last update, as by * CHUNKS_PER_SIDE
+    // + bx; on the first update every texel changed instead
+    const std::vector<int>& getChangedBlocks() const { return m_changedBlocks; }
+    bool isFullyChanged() const { return m_fullyChanged; }
+    
+    size_t getSummaryCount() const { return m_summaries.size(); }
+    
+private:
+    struct ChunkSummary {
+        std::array<uint8_t, TEXELS_PER_CHUNK * TEXELS_PER_CHUNK> texels;
+        uint64_t tick;   // Snapshot tick the texels are from
+    };
+    std::unordered_map<glm::ivec2, ChunkSummary> m_summaries;
+    
+    glm::ivec2 m_origin;
+    bool m_hasOrigin;
+    bool m_fullyChanged;
+    uint64_t m_lastTick;       // Snapshot tick of the last update
+    
+    std::vector<uint8_t> m_texels;
+    std::vector<uint8_t> m_blockChanged;   // Marks for m_changedBlocks, one per block
+    std::vector<int> m_changedBlocks;
+    std::array<uint8_t, 256> m_counts;     // Material histogram scratch, kept zeroed
+    
+    void moveWindow(const glm::ivec2& origin);
+    bool summarize(const ChunkSnapshot& chunk, ChunkSummary& summary, bool whole);
+    void writeBlock(const glm::ivec2& coord, const ChunkSummary* summary);
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace Engine {
+
+// Where recent frames spent their time, in milliseconds, and how much they
+// uploaded, each averaged over the last WINDOW frames. GPU phases come from timestamp queries read back
+// a couple of frames late, and stay zero on devices without timestamps.
+struct RenderTimings {
+    static constexpr int WINDOW = 120;
+    
+    float gpuUpload = 0.0f;     // Texture uploads and their layout barriers
+    float gpuDraw = 0.0f;       // The render pass
+    float gpuPostPass = 0.0f;   // After the pass, e.g. frame capture copies
+    float gpuFrame = 0.0f;      // The whole command buffer
+    float cpuAcquire = 0.0f;    // Waiting for the frame's fence and a swap chain image
+    float cpuRecord = 0.0f;     // Recording commands, from beginFrame to submit
+    float cpuPresent = 0.0f;    // Queueing the image for presentation
+    float renderScale = 1.0f;   // Share of the window size the world was last drawn at
+    
+    // World atlas upload volume per frame, averaged like the timings
+    float atlasTiles = 0.0f;            // Dirty 8x8 tiles uploaded
+    float atlasRegions = 0.0f;          // Copy regions they were merged into
+    float atlasDeferredChunks = 0.0f;   // Chunks left for later frames
+    uint32_t atlasResidentPages = 0;    // Chunks with an atlas page right now
+    
+    uint32_t samples = 0;       // Frames behind the GPU averages, at most WINDOW
+    bool gpuTimestamps = false;
+};
+
+// Mean of the last RenderTimings::WINDOW values added
+class RollingAverage {
+public:
+    RollingAverage() : m_values{}, m_next(0), m_count(0), m_sum(0.0) {}
+    
+    void add(double value) {
+        m_sum += value - m_values[m_next];
+        m_values[m_next] = value;
+        m_next = (m_next + 1) % RenderTimings::WINDOW;
+        if (m_count < RenderTimings::WINDOW) {
+            m_count++;
+        }
+    }
+    
+    float get() const { return m_count > 0 ? static_cast<float>(m_sum / m_count) : 0.0f; }
+    uint32_t getCount() const { return static_cast<uint32_t>(m_count); }
+    
+private:
+    std::array<double, RenderTimings::WINDOW> m_values;
+    int m_next;
+    int m_count;
+    double m_sum;   // Of m_values; drifts by rounding only
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -1,18 +1,76 @@
 #include "Renderer.h"
 #include "VulkanRenderer.h"
-#include "../Procedural/World.h"
+#include "SoftwareRenderer.h"
+#include "../Procedural/WorldSnapshot.h"
+#include "../Procedural/Chunk.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
 namespace Engine {
 
+// Floor division, so negative cells land in the chunk to their left
+static int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// Material IDs of a rectangle of cells, row by row; cells of chunks that
+// aren't loaded read as empty
+static void CopyMaterials(const WorldSnapshot& snapshot, int firstX, int firstY, int width, int height, std::vector<uint8_t>& out) {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    out.resize(static_cast<size_t>(width) * height);
+    
+    for (int row = 0; row < height; row++) {
+        uint8_t* cells = &out[static_cast<size_t>(row) * width];
+        const int chunkY = FloorDiv(firstY + row, chunkSize);
+        const int localY = firstY + row - chunkY * chunkSize;
+        
+        // One span per chunk the row crosses
+        int x = 0;
+        while (x < width) {
+            const int chunkX = FloorDiv(firstX + x, chunkSize);
+            const int localX = firstX + x - chunkX * chunkSize;
+            const int span = std::min(width - x, chunkSize - localX);
+            
+            const ChunkSnapshot* chunk = snapshot.GetChunk(glm::ivec2(chunkX, chunkY));
+            if (chunk) {
+                std::memcpy(cells + x, chunk->GetRow(localY) + localX, span);
+            } else {
+                std::memset(cells + x, 0, span);
+            }
+            x += span;
+        }
+    }
+}
+
+static VkPresentModeKHR ToVkPresentMode(PresentMode mode) {
+    switch (mode) {
+        case PresentMode::Mailbox:
+            return VK_PRESENT_MODE_MAILBOX_KHR;
+        case PresentMode::Immediate:
+            return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        default:
+            return VK_PRESENT_MODE_FIFO_KHR;
+    }
+}
+
 Renderer::Renderer(int screenWidth, int screenHeight, RendererType type)
     : m_screenWidth(screenWidth)
     , m_screenHeight(screenHeight)
     , m_rendererType(type)
-    , m_vulkanRenderer(nullptr) {
+    , m_presentMode(PresentMode::Mailbox)
+    , m_window(nullptr)
+    , m_vulkanRenderer(nullptr)
+    , m_softwareRenderer(nullptr)
+    , m_lastSnapshot(nullptr)
+    , m_lastCameraX(0)
+    , m_lastCameraY(0)
+    , m_lastZoomLevel(1.0f) {
     
-    std::cout << "Creating " << (type == RendererType::Vulkan ? "Vulkan" : "Unknown") 
+    std::cout << "Creating " << (type == RendererType::Vulkan ? "Vulkan" : type == RendererType::Software ? "Software" : "Unknown") 
               << " renderer with dimensions " << screenWidth << "x" << screenHeight << std::endl;
 }
 
@@ -21,6 +79,8 @@ Renderer::~Renderer() {
 }
 
 bool Renderer::initialize(SDL_Window* window) {
+    m_window = window;
+    
     try {
         // Select the appropriate rendering backend
         switch (m_rendererType) {
@@ -32,15 +92,29 @@ bool Renderer::initialize(SDL_Window* window) {
                 
                 std::cout << "Initializing Vulkan renderer..." << std::endl;
                 m_vulkanRenderer = std::make_unique<VulkanRenderer>(m_screenWidth, m_screenHeight);
+                m_vulkanRenderer->setPresentMode(ToVkPresentMode(m_presentMode));
                 
                 if (!m_vulkanRenderer->initialize(window)) {
                     std::cerr << "Failed to initialize Vulkan renderer" << std::endl;
                     return false;
                 }
                 
+                m_vulkanRenderer->setFrameRecorder(&m_frameRecorder);
+                
                 std::cout << "Vulkan renderer initialized successfully" << std::endl;
                 return true;
+            
+            case RendererType::Software:
+                std::cout << "Initializing software renderer..." << std::endl;
+                m_softwareRenderer = std::make_unique<SoftwareRenderer>(m_screenWidth, m_screenHeight);
+                
+                if (!m_softwareRenderer->initialize()) {
+                    std::cerr << "Failed to initialize software renderer" << std::endl;
+                    return false;
+                }
                 
+                return true;
+            
             default:
                 std::cerr << "Unsupported renderer type" << std::endl;
                 return false;
@@ -64,6 +138,14 @@ void Renderer::cleanup() {
             m_vulkanRenderer.reset();
             std::cout << "Vulkan renderer cleanup complete" << std::endl;
         }
+        
+        if (m_softwareRenderer) {
+            m_softwareRenderer->cleanup();
+            m_softwareRenderer.reset();
+        }
+        
+        // Write out whatever is still queued
+        m_frameRecorder.stop();
     } catch (const std::exception& e) {
         std::cerr << "Error during renderer cleanup: " << e.what() << std::endl;
     } catch (...) {
@@ -73,10 +155,22 @@ void Renderer::cleanup() {
     std::cout << "Renderer cleanup finished" << std::endl;
 }
 
+void Renderer::waitForFrame() {
+    try {
+        if (m_vulkanRenderer) {
+            m_vulkanRenderer->waitForFrame();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error waiting for frame: " << e.what() << std::endl;
+    }
+}
+
 void Renderer::beginFrame() {
     try {
         if (m_vulkanRenderer) {
             m_vulkanRenderer->beginFrame();
+        } else if (m_softwareRenderer) {
+            m_softwareRenderer->beginFrame();
         } else {
             std::cerr << "Cannot begin frame - no renderer initialized" << std::endl;
         }
@@ -88,19 +182,34 @@ void Renderer::beginFrame() {
 void Renderer::endFrame() {
     try {
         if (m_vulkanRenderer) {
+            captureFrame();
             m_vulkanRenderer->endFrame();
+        } else if (m_softwareRenderer) {
+            m_softwareRenderer->endFrame();
+            captureFrame();
+            presentSoftwareFrame();
         } else {
             std::cerr << "Cannot end frame - no renderer initialized" << std::endl;
         }
     } catch (const std::exception& e) {
         std::cerr << "Error ending frame: " << e.what() << std::endl;
     }
+    
+    // The snapshot may change before the next frame
+    m_lastSnapshot = nullptr;
 }
 
-void Renderer::renderWorld(const World& world, int cameraX, int cameraY, float zoomLevel) {
+void Renderer::renderWorld(const WorldSnapshot& snapshot, int cameraX, int cameraY, float zoomLevel) {
+    m_lastSnapshot = &snapshot;
+    m_lastCameraX = cameraX;
+    m_lastCameraY = cameraY;
+    m_lastZoomLevel = zoomLevel;
+    
     try {
         if (m_vulkanRenderer) {
-            m_vulkanRenderer->renderWorld(world, cameraX, cameraY, zoomLevel);
+            m_vulkanRenderer->renderWorld(snapshot, cameraX, cameraY, zoomLevel);
+        } else if (m_softwareRenderer) {
+            m_softwareRenderer->renderWorld(snapshot, cameraX, cameraY, zoomLevel);
         } else {
             std::cerr << "Cannot render world - no renderer initialized" << std::endl;
         }
@@ -118,24 +227,38 @@ void Renderer::handleResize(int width, int height) {
     if (m_vulkanRenderer) {
         m_vulkanRenderer->handleResize(width, height);
     }
+    
+    if (m_softwareRenderer) {
+        m_softwareRenderer->handleResize(width, height);
+    }
 }
 
 void Renderer::setClearColor(float r, float g, float b, float a) {
     if (m_vulkanRenderer) {
         m_vulkanRenderer->setClearColor(r, g, b, a);
     }
+    
+    if (m_softwareRenderer) {
+        m_softwareRenderer->setClearColor(r, g, b, a);
+    }
 }
 
 void Renderer::setViewport(int x, int y, int width, int height) {
     if (m_vulkanRenderer) {
         m_vulkanRenderer->setViewport(x, y, width, height);
     }
+    
+    if (m_softwareRenderer) {
+        m_softwareRenderer->setViewport(x, y, width, height);
+    }
 }
 
 std::string Renderer::getRendererInfo() const {
     switch (m_rendererType) {
         case RendererType::Vulkan:
             return "Vulkan Renderer";
+        case RendererType::Software:
+            return "Software Renderer";
         default:
             return "Unknown Renderer";
     }
@@ -147,13 +270,163 @@ bool Renderer::supportsFeature(const std::string& featureName) const {
     if (featureName == "vulkan" && m_rendererType == RendererType::Vulkan) {
         return true;
     }
+    if (featureName == "frame_capture" && m_rendererType == RendererType::Software) {
+        return true;
+    }
+    if (featureName == "fog_of_war" && m_rendererType == RendererType::Software) {
+        return true;
+    }
+    if (featureName == "minimap" && m_rendererType == RendererType::Vulkan) {
+        return true;
+    }
+    if (featureName == "frame_recording") {
+        return true;
+    }
     return false;
 }
 
+RenderTimings Renderer::getRenderTimings() const {
+    if (m_vulkanRenderer) {
+        return m_vulkanRenderer->getRenderTimings();
+    }
+    return RenderTimings{};
+}
+
+std::string Renderer::getTimingReport() const {
+    const RenderTimings timings = getRenderTimings();
+    
+    char report[384];
+    std::snprintf(report, sizeof(report),
+        "gpu_upload=%.3f gpu_draw=%.3f gpu_post=%.3f gpu_frame=%.3f "
+        "cpu_acquire=%.3f cpu_record=%.3f cpu_present=%.3f scale=%.2f frames=%u%s "
+        "atlas_tiles=%.1f atlas_regions=%.1f atlas_deferred=%.1f atlas_pages=%u",
+        timings.gpuUpload, timings.gpuDraw, timings.gpuPostPass, timings.gpuFrame,
+        timings.cpuAcquire, timings.cpuRecord, timings.cpuPresent, timings.renderScale, timings.samples,
+        timings.gpuTimestamps ? "" : " (no gpu timestamps)",
+        timings.atlasTiles, timings.atlasRegions, timings.atlasDeferredChunks, timings.atlasResidentPages);
+    return report;
+}
+
+void Renderer::setDynamicResolution(bool enabled, float budgetMs) {
+    if (m_vulkanRenderer) {
+        m_vulkanRenderer->setDynamicResolution(enabled, budgetMs);
+    }
+}
+
+void Renderer::setPresentMode(PresentMode mode) {
+    m_presentMode = mode;
+    if (m_vulkanRenderer) {
+        m_vulkanRenderer->setPresentMode(ToVkPresentMode(mode));
+    }
+}
+
+void Renderer::setMinimapVisible(bool visible) {
+    if (m_vulkanRenderer) {
+        m_vulkanRenderer->setMinimapVisible(visible);
+    }
+}
+
+bool Renderer::isMinimapVisible() const {
+    return m_vulkanRenderer && m_vulkanRenderer->isMinimapVisible();
+}
+
+void Renderer::setVisibility(const VisibilityMap* visibility) {
+    if (m_vulkanRenderer) {
+        m_vulkanRenderer->setVisibility(visibility);
+    }
+    if (m_softwareRenderer) {
+        m_softwareRenderer->setVisibility(visibility);
+    }
+}
+
+bool Renderer::saveFrame(const std::string& filename) const {
+    if (!m_softwareRenderer) {
+        std::cerr << "Frame capture needs the software renderer" << std::endl;
+        return false;
+    }
+    
+    return m_softwareRenderer->writePPM(filename);
+}
+
+void Renderer::setFrameDumpDirectory(const std::string& directory) {
+    if (!m_softwareRenderer) {
+        std::cerr << "Frame dumps need the software renderer" << std::endl;
+        return;
+    }
+    
+    m_softwareRenderer->setFrameDumpDirectory(directory);
+}
+
+bool Renderer::startRecording(const std::string& directory, CaptureFormat format, bool dumpMaterials) {
+    return m_frameRecorder.start(directory, format, dumpMaterials);
+}
+
+void Renderer::stopRecording() {
+    m_frameRecorder.stop();
+}
+
+void Renderer::captureFrame() {
+    CapturedFrame* frame = m_frameRecorder.acquireFrame();
+    if (!frame)
+        return;
+    
+    // The cells under the screen, with the same mapping as the renderers
+    if (m_frameRecorder.dumpsMaterials() && m_lastSnapshot && m_lastZoomLevel > 0.0f) {
+        const int firstX = static_cast<int>(std::floor(m_lastCameraX - (m_screenWidth / 2) / m_lastZoomLevel));
+        const int firstY = static_cast<int>(std::floor(m_lastCameraY - (m_screenHeight / 2) / m_lastZoomLevel));
+        const int lastX = static_cast<int>(std::floor(m_lastCameraX + (m_screenWidth - 1 - m_screenWidth / 2) / m_lastZoomLevel));
+        const int lastY = static_cast<int>(std::floor(m_lastCameraY + (m_screenHeight - 1 - m_screenHeight / 2) / m_lastZoomLevel));
+        
+        frame->materialWidth = lastX - firstX + 1;
+        frame->materialHeight = lastY - firstY + 1;
+        CopyMaterials(*m_lastSnapshot, firstX, firstY, frame->materialWidth, frame->materialHeight, frame->materials);
+    }
+    
+    // The GPU copies the image out; the frame is submitted once it has
+    if (m_vulkanRenderer) {
+        m_vulkanRenderer->captureFrame(frame);
+        return;
+    }
+    
+    const std::vector<uint32_t>& pixels = m_softwareRenderer->getFramebuffer();
+    frame->width = m_softwareRenderer->getWidth();
+    frame->height = m_softwareRenderer->getHeight();
+    frame->bgra = false;
+    frame->pixels.resize(pixels.size() * sizeof(uint32_t));
+    std::memcpy(frame->pixels.data(), pixels.data(), frame->pixels.size());
+    m_frameRecorder.submitFrame(frame);
+}
+
+void Renderer::presentSoftwareFrame() {
+    if (!m_window)
+        return;
+    
+    SDL_Surface* windowSurface = SDL_GetWindowSurface(m_window);
+    if (!windowSurface)
+        return;
+    
+    // Wrap the framebuffer without copying; SDL converts while blitting
+    const std::vector<uint32_t>& pixels = m_softwareRenderer->getFramebuffer();
+    SDL_Surface* frame = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<uint32_t*>(pixels.data()),
+        m_softwareRenderer->getWidth(), m_softwareRenderer->getHeight(),
+        32, m_softwareRenderer->getWidth() * 4,
+        SDL_PIXELFORMAT_RGBA32
+    );
+    if (!frame)
+        return;
+    
+    SDL_BlitSurface(frame, nullptr, windowSurface, nullptr);
+    SDL_FreeSurface(frame);
+    SDL_UpdateWindowSurface(m_window);
+}
+
 bool Renderer::isRendererAvailable(RendererType type) {
     switch (type) {
         case RendererType::Vulkan:
             return VulkanRenderer::isVulkanAvailable();
+        case RendererType::Software:
+            return true;
         default:
             return false;
     }
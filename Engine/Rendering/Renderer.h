@@ -3,15 +3,27 @@
 #include <memory>
 #include <string>
 #include <SDL2/SDL.h>
+#include "FrameRecorder.h"
+#include "RenderTimings.h"
 
 namespace Engine {
 
 // Forward declarations
-class World;
+class WorldSnapshot;
+class VisibilityMap;
 class VulkanRenderer;
+class SoftwareRenderer;
 
 enum class RendererType {
-    Vulkan
+    Vulkan,
+    Software    // CPU composition; works without a GPU or window
+};
+
+// How finished frames reach the screen (Vulkan backend)
+enum class PresentMode {
+    Fifo,       // V-sync; every frame is shown, the queue can add latency
+    Mailbox,    // V-sync, the newest frame replaces a waiting one
+    Immediate   // No v-sync; may tear
 };
 
 // A clean, high-level interface to our rendering system
@@ -19,15 +31,19 @@ class Renderer {
 public:
     Renderer(int screenWidth, int screenHeight, RendererType type = RendererType::Vulkan);
     ~Renderer();
-
-    // Initialization and shutdown
+    
+    // Initialization and shutdown. The software backend accepts a null
+    // window and then renders off-screen only.
     bool initialize(SDL_Window* window);
     void cleanup();
     
-    // Core rendering methods
+    // Core rendering methods. waitForFrame blocks until the GPU can take
+    // another frame; beginFrame does too, but calling it first keeps that
+    // wait from landing between reading input and drawing.
+    void waitForFrame();
     void beginFrame();
     void endFrame();
-    void renderWorld(const World& world, int cameraX = 0, int cameraY = 0, float zoomLevel = 1.0f);
+    void renderWorld(const WorldSnapshot& snapshot, int cameraX = 0, int cameraY = 0, float zoomLevel = 1.0f);
     
     // Window event handling
     void handleResize(int width, int height);
@@ -40,16 +56,67 @@ public:
     std::string getRendererInfo() const;
     bool supportsFeature(const std::string& featureName) const;
     
+    // Recent per-phase frame timings and atlas upload volume (Vulkan backend;
+    // zero otherwise), and the same as one key=value line for logs
+    RenderTimings getRenderTimings() const;
+    std::string getTimingReport() const;
+    
+    // Draw the world below full resolution while GPU frames take longer than
+    // the budget (Vulkan backend with GPU timestamps only)
+    void setDynamicResolution(bool enabled, float budgetMs);
+    
+    // Present mode to ask for; FIFO when unsupported. May be set before
+    // initialize; later calls rebuild the swap chain.
+    void setPresentMode(PresentMode mode);
+    PresentMode getPresentMode() const { return m_presentMode; }
+    
+    // Overview of the area around the camera in a screen corner (Vulkan backend)
+    void setMinimapVisible(bool visible);
+    bool isMinimapVisible() const;
+    
+    // Fog of war outside what the map shows as visible; null turns it off.
+    // The map is read while renderWorld runs.
+    void setVisibility(const VisibilityMap* visibility);
+    
+    // Frame capture (software backend only); frames are written as PPM
+    bool saveFrame(const std::string& filename) const;
+    void setFrameDumpDirectory(const std::string& directory);
+    
+    // Recording with either backend: frames are copied off the frame loop
+    // and written by a background thread, dropping frames it can't keep up with
+    bool startRecording(const std::string& directory, CaptureFormat format, bool dumpMaterials);
+    void stopRecording();
+    bool isRecording() const { return m_frameRecorder.isRecording(); }
+    
     // Static helper to check for rendering system availability
     static bool isRendererAvailable(RendererType type);
-
+    
 private:
     int m_screenWidth;
     int m_screenHeight;
     RendererType m_rendererType;
+    PresentMode m_presentMode;
+    SDL_Window* m_window;
     
-    // Backend renderer implementation (Vulkan only for now)
+    // Declared before the backends so it outlives them; they may still hold
+    // recorded frames in flight
+    FrameRecorder m_frameRecorder;
+    
+    // Backend renderer implementation; only the selected one exists
     std::unique_ptr<VulkanRenderer> m_vulkanRenderer;
+    std::unique_ptr<SoftwareRenderer> m_softwareRenderer;
+    
+    // What the last renderWorld showed, for the material dump
+    const WorldSnapshot* m_lastSnapshot;
+    int m_lastCameraX;
+    int m_lastCameraY;
+    float m_lastZoomLevel;
+    
+    // Copy the software framebuffer to the window, if there is one
+    void presentSoftwareFrame();
+    
+    // Hand this frame to the recorder, if recording
+    void captureFrame();
 };
 
 } // namespace Engine
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "SoftwareRenderer.h"
+#include "../Procedural/WorldSnapshot.h"
+#include "../Procedural/Chunk.h"
+#include "../Procedural/VisibilityMap.h"
+#include "../Simulation/Material.h"
+#include "../Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Engine {
+
+// Floor division, so negative cells land in the chunk to their left
+static int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// Pixel with the given bytes in R, G, B, A memory order
+static uint32_t PackPixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    const uint8_t bytes[4] = { r, g, b, a };
+    uint32_t pixel;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+static uint8_t ToByte(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Brightness left to cells hidden by fog of war
+static const float FOG_BRIGHTNESS = 0.3f;
+
+SoftwareRenderer::SoftwareRenderer(int screenWidth, int screenHeight)
+    : m_width(screenWidth)
+    , m_height(screenHeight)
+    , m_clearColor{0.1f, 0.2f, 0.4f, 1.0f} // Same background as the Vulkan renderer
+    , m_clearPixel(0)
+    , m_gridPixel(0)
+    , m_visibility(nullptr)
+    , m_fogPixel(0)
+    , m_frameIndex(0) {
+    
+    m_palette.fill(0);
+    m_fogPalette.fill(0);
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    cleanup();
+}
+
+bool SoftwareRenderer::initialize() {
+    if (m_width <= 0 || m_height <= 0) {
+        std::cerr << "Invalid software framebuffer size " << m_width << "x" << m_height << std::endl;
+        return false;
+    }
+    
+    m_framebuffer.assign(static_cast<size_t>(m_width) * m_height, 0);
+    refreshPalette();
+    
+    std::cout << "Software renderer initialized (" << m_width << "x" << m_height << ", "
+              << JobSystem::Get().GetWorkerCount() + 1 << " threads)" << std::endl;
+    return true;
+}
+
+void SoftwareRenderer::cleanup() {
+    m_framebuffer.clear();
+    m_framebuffer.shrink_to_fit();
+}
+
+void SoftwareRenderer::beginFrame() {
+    std::fill(m_framebuffer.begin(), m_framebuffer.end(), m_clearPixel);
+}
+
+void SoftwareRenderer::endFrame() {
+    if (!m_frameDumpDirectory.empty()) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06llu.ppm", static_cast<unsigned long long>(m_frameIndex));
+        writePPM((std::filesystem::path(m_frameDumpDirectory) / name).string());
+    }
+    
+    m_frameIndex++;
+}
+
+void SoftwareRenderer::renderWorld(const WorldSnapshot& snapshot, int cameraX, int cameraY, float zoomLevel) {
+    if (m_framebuffer.empty() || zoomLevel <= 0.0f)
+        return;
+    
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    
+    // Same mapping as particle.frag: the camera sits at the screen center and
+    // every pixel shows the cell under its top-left corner
+    const int halfWidth = m_width / 2;
+    m_columnChunk.resize(m_width);
+    m_columnLocal.resize(m_width);
+    for (int x = 0; x < m_width; x++) {
+        const int cellX = static_cast<int>(std::floor(cameraX + (x - halfWidth) / zoomLevel));
+        m_columnChunk[x] = FloorDiv(cellX, chunkSize);
+        m_columnLocal[x] = cellX - m_columnChunk[x] * chunkSize;
+    }
+    
+    // Bands of rows run on the job system; each writes only its own rows
+    const int bandCount = (m_height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    JobSystem::Get().ParallelFor(0, bandCount, [&](int band) {
+        const int firstRow = band * BAND_HEIGHT;
+        renderBand(snapshot, firstRow, std::min(m_height, firstRow + BAND_HEIGHT), cameraY, zoomLevel);
+    });
+}
+
+void SoftwareRenderer::renderBand(const WorldSnapshot& snapshot, int firstRow, int lastRow, int cameraY, float zoomLevel) {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    const int halfHeight = m_height / 2;
+    int previousCellY = 0;
+    
+    for (int row = firstRow; row < lastRow; row++) {
+        uint32_t* out = &m_framebuffer[static_cast<size_t>(row) * m_width];
+        const int cellY = static_cast<int>(std::floor(cameraY + (row - halfHeight) / zoomLevel));
+        
+        // Zoomed in, neighboring rows often show the same cells
+        if (row > firstRow && cellY == previousCellY) {
+            std::memcpy(out, out - m_width, m_width * sizeof(uint32_t));
+            continue;
+        }
+        previousCellY = cellY;
+        
+        const int chunkY = FloorDiv(cellY, chunkSize);
+        const int localY = cellY - chunkY * chunkSize;
+        const bool gridRow = localY == 0;
+        
+        // Walk the row one chunk at a time, so each chunk is looked up once
+        int x = 0;
+        while (x < m_width) {
+            const int chunkX = m_columnChunk[x];
+            int end = x + 1;
+            while (end < m_width && m_columnChunk[end] == chunkX) {
+                end++;
+            }
+            
+            const ChunkSnapshot* chunk = snapshot.GetChunk(glm::ivec2(chunkX, chunkY));
+            if (!chunk) {
+                std::fill(out + x, out + end, m_clearPixel);
+                x = end;
+                continue;
+            }
+            
+            // Without fog every cell counts as visible
+            uint64_t visibleCells = ~0ULL;
+            if (m_visibility) {
+                const uint64_t* mask = m_visibility->GetChunkMask(glm::ivec2(chunkX, chunkY));
+                visibleCells = mask ? mask[localY] : 0;
+            }
+            
+            const uint8_t* cells = chunk->GetRow(localY);
+            for (; x < end; x++) {
+                const int localX = m_columnLocal[x];
+                const uint8_t materialID = cells[localX];
+                if (!((visibleCells >> localX) & 1)) {
+                    out[x] = materialID != 0 ? m_fogPalette[materialID] : m_fogPixel;
+                } else if (materialID != 0) {
+                    out[x] = m_palette[materialID];
+                } else {
+                    out[x] = (gridRow || localX == 0) ? m_gridPixel : m_clearPixel;
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::handleResize(int width, int height) {
+    if (width <= 0 || height <= 0)
+        return;
+    
+    m_width = width;
+    m_height = height;
+    m_framebuffer.assign(static_cast<size_t>(m_width) * m_height, m_clearPixel);
+}
+
+void SoftwareRenderer::setClearColor(float r, float g, float b, float a) {
+    m_clearColor[0] = r;
+    m_clearColor[1] = g;
+    m_clearColor[2] = b;
+    m_clearColor[3] = a;
+    
+    // Every palette entry is blended over the clear color
+    refreshPalette();
+}
+
+void SoftwareRenderer::setViewport(int x, int y, int width, int height) {
+    // Like the Vulkan backend, frames always cover the whole framebuffer
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+}
+
+void SoftwareRenderer::refreshPalette() {
+    m_clearPixel = PackPixel(ToByte(m_clearColor[0]), ToByte(m_clearColor[1]), ToByte(m_clearColor[2]), 255);
+    
+    // Faint grid, as drawn by particle.frag
+    const float grid = 50.0f / 255.0f;
+    m_gridPixel = blendOverClear(grid, grid, grid, grid);
+    m_fogPixel = PackPixel(ToByte(m_clearColor[0] * FOG_BRIGHTNESS), ToByte(m_clearColor[1] * FOG_BRIGHTNESS),
+                           ToByte(m_clearColor[2] * FOG_BRIGHTNESS), 255);
+    
+    const MaterialDatabase& materials = MaterialDatabase::Get();
+    for (int id = 0; id < 256; id++) {
+        if (id == 0 || !materials.HasMaterial(static_cast<uint8_t>(id))) {
+            m_palette[id] = m_clearPixel;
+            m_fogPalette[id] = m_fogPixel;
+            continue;
+        }
+        
+        const glm::vec4& color = materials.GetMaterial(static_cast<uint8_t>(id)).color;
+        m_palette[id] = blendOverClear(color.r, color.g, color.b, color.a);
+        
+        // The same blend, darkened
+        const float r = m_clearColor[0] + (color.r - m_clearColor[0]) * color.a;
+        const float g = m_clearColor[1] + (color.g - m_clearColor[1]) * color.a;
+        const float b = m_clearColor[2] + (color.b - m_clearColor[2]) * color.a;
+        m_fogPalette[id] = PackPixel(ToByte(r * FOG_BRIGHTNESS), ToByte(g * FOG_BRIGHTNESS), ToByte(b * FOG_BRIGHTNESS), 255);
+    }
+}
+
+uint32_t SoftwareRenderer::blendOverClear(float r, float g, float b, float a) const {
+    // Source-alpha blending, as in the Vulkan pipeline
+    return PackPixel(
+        ToByte(r * a + m_clearColor[0] * (1.0f - a)),
+        ToByte(g * a + m_clearColor[1] * (1.0f - a)),
+        ToByte(b * a + m_clearColor[2] * (1.0f - a)),
+        255
+    );
+}
+
+bool SoftwareRenderer::writePPM(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for frame dump: " << filename << std::endl;
+        return false;
+    }
+    
+    file << "P6\n" << m_width << " " << m_height << "\n255\n";
+    
+    std::vector<uint8_t> row(static_cast<size_t>(m_width) * 3);
+    for (int y = 0; y < m_height; y++) {
+        const uint8_t* pixels = reinterpret_cast<const uint8_t*>(&m_framebuffer[static_cast<size_t>(y) * m_width]);
+        for (int x = 0; x < m_width; x++) {
+            row[x * 3 + 0] = pixels[x * 4 + 0];
+            row[x * 3 + 1] = pixels[x * 4 + 1];
+            row[x * 3 + 2] = pixels[x * 4 + 2];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    
+    return file.good();
+}
+
+void SoftwareRenderer::setFrameDumpDirectory(const std::string& directory) {
+    m_frameDumpDirectory = directory;
+    if (!directory.empty()) {
+        std::filesystem::create_directories(directory);
+    }
+}
+
+} // namespace Engine
\ No newline at end of file
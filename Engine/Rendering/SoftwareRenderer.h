@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+// Forward declarations
+class WorldSnapshot;
+class VisibilityMap;
+
+// CPU rendering backend. Composes the world into an in-memory RGBA8
+// framebuffer with the same camera and zoom semantics as the Vulkan
+// renderer, using the material colors and chunk grid but none of the
+// shader effects. It needs no window or GPU, so it also serves headless
+// replays, thumbnails and render benchmarks.
+class SoftwareRenderer {
+public:
+    SoftwareRenderer(int screenWidth, int screenHeight);
+    ~SoftwareRenderer();
+    
+    bool initialize();
+    void cleanup();
+    
+    void beginFrame();
+    void endFrame();
+    void renderWorld(const WorldSnapshot& snapshot, int cameraX, int cameraY, float zoomLevel);
+    
+    void handleResize(int width, int height);
+    void setClearColor(float r, float g, float b, float a);
+    void setViewport(int x, int y, int width, int height);
+    
+    // Rebuild the material color table, e.g. after materials were reloaded
+    void refreshPalette();
+    
+    // Darken cells the map doesn't show as visible; null turns fog off. The
+    // map must stay alive and unchanged while frames render.
+    void setVisibility(const VisibilityMap* visibility) { m_visibility = visibility; }
+    
+    // Row-major pixels, top row first; each holds R, G, B, A bytes in memory order
+    const std::vector<uint32_t>& getFramebuffer() const { return m_framebuffer; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    
+    // Binary PPM (P6) of the current framebuffer; alpha is dropped
+    bool writePPM(const std::string& filename) const;
+    
+    // Write every finished frame as frame_NNNNNN.ppm into the directory;
+    // an empty directory turns dumping off
+    void setFrameDumpDirectory(const std::string& directory);
+    
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint32_t> m_framebuffer;
+    
+    // Material colors already blended over the clear color, indexed by
+    // material ID; unknown materials show the clear color
+    std::array<uint32_t, 256> m_palette;
+    float m_clearColor[4];
+    uint32_t m_clearPixel;
+    uint32_t m_gridPixel;   // Chunk border lines in empty space
+    
+    // Fog of war: the palette and empty space as shown outside the viewer's sight
+    const VisibilityMap* m_visibility;
+    std::array<uint32_t, 256> m_fogPalette;
+    uint32_t m_fogPixel;
+    
+    // Per-column lookups for the current frame
+    std::vector<int> m_columnChunk;  // Chunk x under each column
+    std::vector<int> m_columnLocal;  // Cell x within that chunk
+    
+    std::string m_frameDumpDirectory;
+    uint64_t m_frameIndex;
+    
+    // Rows per job
+    static constexpr int BAND_HEIGHT = 16;
+    
+    void renderBand(const WorldSnapshot& snapshot, int firstRow, int lastRow, int cameraY, float zoomLevel);
+    uint32_t blendOverClear(float r, float g, float b, float a) const;
+};
+
+} // namespace Engine
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "VulkanRenderer.h"
-#include "../Procedural/World.h"
+#include "FrameRecorder.h"
+#include "../Procedural/WorldSnapshot.h"
+#include "../Procedural/Chunk.h"
+#include "../Procedural/VisibilityMap.h"
 #include "../Simulation/Material.h"
+#include "../Core/JobSystem.h"
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
@@ -12,9 +16,78 @@
 #include <array>
 #include <set>
 #include <chrono>
+#include <filesystem>
+#include <cmath>
+#include <cstddef>
 
 namespace Engine {
 
+// Mirrors the std140 UniformBufferObject block in particle.vert/particle.frag;
+// vec2 and ivec2 members align to 8 bytes
+struct UniformBufferObject {
+    alignas(4) float time;                  // Total elapsed time
+    alignas(4) float deltaTime;             // Time since last frame
+    alignas(8) glm::vec2 resolution;        // Framebuffer size in pixels
+    alignas(8) glm::vec2 worldOffset;       // Camera position in world cells
+    alignas(4) float zoomLevel;             // Screen pixels per cell
+    alignas(8) glm::ivec2 pageTableOrigin;  // First chunk of the page table window
+    alignas(8) glm::ivec2 lightMapOrigin;   // Chunk at light map texel (0, 0)
+    alignas(16) glm::vec4 minimapRect;      // Minimap quad in pixels: x, y, width, height
+    alignas(8) glm::ivec2 minimapOrigin;    // First chunk of the minimap window
+    alignas(4) int fogEnabled;              // Nonzero to darken cells out of sight
+};
+
+static_assert(offsetof(UniformBufferObject, time) == 0, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, deltaTime) == 4, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, resolution) == 8, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, worldOffset) == 16, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, zoomLevel) == 24, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, pageTableOrigin) == 32, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, lightMapOrigin) == 40, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, minimapRect) == 48, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, minimapOrigin) == 64, "UBO layout must match the shaders");
+static_assert(offsetof(UniformBufferObject, fogEnabled) == 72, "UBO layout must match the shaders");
+
+// One entry of the MaterialPalette block in particle.frag
+struct PaletteEntry {
+    glm::vec4 color;    // Base color and alpha
+    glm::vec4 effects;  // x = grain, y = liquid shimmer, z = glow, w = flicker
+};
+
+static_assert(sizeof(PaletteEntry) == 32, "Palette layout must match the shaders");
+
+// On-disk pipeline cache: this header, then the driver's cache blob
+static const char* PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+static const uint32_t PIPELINE_CACHE_MAGIC = 0x43505944; // "DYPC"
+
+struct PipelineCacheFileHeader {
+    uint32_t magic;
+    uint32_t dataSize;
+    uint64_t dataHash;                       // FNV-1a of the blob
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+// The header Vulkan puts at the start of every cache blob
+struct PipelineCacheBlobHeader {
+    uint32_t headerSize;
+    uint32_t headerVersion;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+};
+
+static uint64_t HashBytes(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 // Helper function to check Vulkan availability
 bool VulkanRenderer::isVulkanAvailable() {
     SDL_Window* testWindow = SDL_CreateWindow(
@@ -45,7 +118,9 @@ VulkanRenderer::VulkanRenderer(int screenWidth, int screenHeight, const std::str
     , m_clearColor{0.1f, 0.2f, 0.4f, 1.0f} // Purple background for visibility
     , m_currentFrame(0)
     , m_currentImageIndex(0)
-    , m_framebufferResized(false) {
+    , m_framebufferResized(false)
+    , m_frameActive(false)
+    , m_renderPassActive(false) {
     
     // Initialize Vulkan members
     m_instance = VK_NULL_HANDLE;
@@ -53,12 +128,51 @@ VulkanRenderer::VulkanRenderer(int screenWidth, int screenHeight, const std::str
     m_device = VK_NULL_HANDLE;
     m_surface = VK_NULL_HANDLE;
     m_swapchain = VK_NULL_HANDLE;
+    m_requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    m_presentMode = VK_PRESENT_MODE_FIFO_KHR;
     m_renderPass = VK_NULL_HANDLE;
     m_pipelineLayout = VK_NULL_HANDLE;
     m_graphicsPipeline = VK_NULL_HANDLE;
+    m_pipelineCache = VK_NULL_HANDLE;
     m_commandPool = VK_NULL_HANDLE;
     m_debugMessenger = VK_NULL_HANDLE;
     
+    // Atlas and page table are created in initialize()
+    m_worldAtlas = {};
+    m_pageTableTexture = {};
+    m_atlasFrame = 0;
+    m_pageTableOrigin = glm::ivec2(0, 0);
+    m_lightMapTexture = {};
+    m_lightMapOrigin = glm::ivec2(0, 0);
+    m_lightMapStale = true;
+    m_minimapTexture = {};
+    m_minimapOrigin = glm::ivec2(0, 0);
+    m_minimapStale = true;
+    m_minimapVisible = true;
+    m_visibility = nullptr;
+    m_fogTexture = {};
+    m_descriptorPool = VK_NULL_HANDLE;
+    m_descriptorSetLayout = VK_NULL_HANDLE;
+    m_paletteBuffer = VK_NULL_HANDLE;
+    m_paletteBufferMemory = VK_NULL_HANDLE;
+    m_stagingBuffer = VK_NULL_HANDLE;
+    m_stagingBufferMemory = VK_NULL_HANDLE;
+    m_stagingMapped = nullptr;
+    m_stagingHead = 0;
+    m_captureReadbacks.assign(MAX_FRAMES_IN_FLIGHT, CaptureReadback{});
+    m_frameRecorder = nullptr;
+    m_pendingCapture = nullptr;
+    m_swapchainCapturable = false;
+    m_timestampPool = VK_NULL_HANDLE;
+    m_timestampPeriod = 0.0;
+    m_timestampMask = 0;
+    m_timestampsWritten.assign(MAX_FRAMES_IN_FLIGHT, 0);
+    m_scaledRenderPass = VK_NULL_HANDLE;
+    m_swapchainScalable = false;
+    m_dynamicResolutionEnabled = false;
+    m_renderScale = 1.0f;
+    m_renderExtent = {static_cast<uint32_t>(m_screenWidth), static_cast<uint32_t>(m_screenHeight)};
+    
     // Initialize viewport and scissor
     m_viewport = {
         0.0f, 0.0f,
@@ -134,6 +248,11 @@ bool VulkanRenderer::initialize(SDL_Window* window) {
         return false;
     }
     
+    // Load the pipeline cache; without one the pipeline is just built from scratch
+    if (!createPipelineCache()) {
+        std::cerr << "Failed to create pipeline cache, continuing without one" << std::endl;
+    }
+    
     // Create graphics pipeline
     if (!createGraphicsPipeline()) {
         std::cerr << "Failed to create graphics pipeline" << std::endl;
@@ -146,15 +265,44 @@ bool VulkanRenderer::initialize(SDL_Window* window) {
         return false;
     }
     
+    // Create dynamic resolution targets; without them frames are always drawn at full size
+    if (!createScaledTargets()) {
+        std::cerr << "Dynamic resolution is not available, drawing at full resolution" << std::endl;
+    }
+    
     // Create command pool
     if (!createCommandPool()) {
         std::cerr << "Failed to create command pool" << std::endl;
         return false;
     }
     
-    // Create world texture
-    if (!createWorldTexture(m_screenWidth, m_screenHeight)) {
-        std::cerr << "Failed to create world texture" << std::endl;
+    // Create world atlas
+    if (!createWorldAtlas()) {
+        std::cerr << "Failed to create world atlas" << std::endl;
+        return false;
+    }
+    
+    // Create page table
+    if (!createPageTable()) {
+        std::cerr << "Failed to create page table" << std::endl;
+        return false;
+    }
+    
+    // Create light map
+    if (!createLightMap()) {
+        std::cerr << "Failed to create light map" << std::endl;
+        return false;
+    }
+    
+    // Create minimap
+    if (!createMinimap()) {
+        std::cerr << "Failed to create minimap" << std::endl;
+        return false;
+    }
+    
+    // Create fog of war masks
+    if (!createFogTexture()) {
+        std::cerr << "Failed to create fog texture" << std::endl;
         return false;
     }
     
@@ -170,9 +318,21 @@ bool VulkanRenderer::initialize(SDL_Window* window) {
         return false;
     }
     
-    // Create uniform buffer
-    if (!createUniformBuffer()) {
-        std::cerr << "Failed to create uniform buffer" << std::endl;
+    // Create uniform buffers
+    if (!createUniformBuffers()) {
+        std::cerr << "Failed to create uniform buffers" << std::endl;
+        return false;
+    }
+    
+    // Create material palette
+    if (!createPaletteBuffer()) {
+        std::cerr << "Failed to create material palette" << std::endl;
+        return false;
+    }
+    
+    // Create staging ring
+    if (!createStagingBuffer()) {
+        std::cerr << "Failed to create staging buffer" << std::endl;
         return false;
     }
     
@@ -200,6 +360,11 @@ bool VulkanRenderer::initialize(SDL_Window* window) {
         return false;
     }
     
+    // Create timestamp queries; without them only CPU timings are reported
+    if (!createTimestampQueries()) {
+        std::cerr << "GPU timestamps are not available, reporting CPU timings only" << std::endl;
+    }
+    
     std::cout << "Vulkan renderer initialized successfully" << std::endl;
     return true;
 }
@@ -238,15 +403,57 @@ void VulkanRenderer::cleanup() {
     
     cleanupSwapChain();
     
-    // Clean up uniform buffer
+    // Clean up uniform buffers (freeing the memory unmaps it)
+    if (m_device != VK_NULL_HANDLE) {
+        for (size_t i = 0; i < m_uniformBuffers.size(); i++) {
+            vkDestroyBuffer(m_device, m_uniformBuffers[i], nullptr);
+            vkFreeMemory(m_device, m_uniformBuffersMemory[i], nullptr);
+        }
+        m_uniformBuffers.clear();
+        m_uniformBuffersMemory.clear();
+        m_uniformBuffersMapped.clear();
+        
+        if (m_paletteBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(m_device, m_paletteBuffer, nullptr);
+            m_paletteBuffer = VK_NULL_HANDLE;
+        }
+        if (m_paletteBufferMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_paletteBufferMemory, nullptr);
+            m_paletteBufferMemory = VK_NULL_HANDLE;
+        }
+    }
+    
+    // Clean up staging ring
     if (m_device != VK_NULL_HANDLE) {
-        if (m_uniformBuffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(m_device, m_uniformBuffer, nullptr);
+        if (m_stagingBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(m_device, m_stagingBuffer, nullptr);
+            m_stagingBuffer = VK_NULL_HANDLE;
         }
-        if (m_uniformBufferMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(m_device, m_uniformBufferMemory, nullptr);
+        if (m_stagingBufferMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, m_stagingBufferMemory, nullptr);
+            m_stagingBufferMemory = VK_NULL_HANDLE;
+        }
+        m_stagingMapped = nullptr;
+    }
+    
+    // Clean up timestamp queries
+    if (m_device != VK_NULL_HANDLE && m_timestampPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(m_device, m_timestampPool, nullptr);
+        m_timestampPool = VK_NULL_HANDLE;
+    }
+    
+    // Hand over the last recorded frames; the device is idle, so their
+    // copies have landed
+    if (m_device != VK_NULL_HANDLE) {
+        for (CaptureReadback& readback : m_captureReadbacks) {
+            finishCapture(readback);
+            destroyCaptureReadback(readback);
         }
     }
+    if (m_pendingCapture) {
+        m_frameRecorder->releaseFrame(m_pendingCapture);
+        m_pendingCapture = nullptr;
+    }
     
     // Clean up descriptor pool
     if (m_device != VK_NULL_HANDLE && m_descriptorPool != VK_NULL_HANDLE) {
@@ -278,20 +485,26 @@ void VulkanRenderer::cleanup() {
         }
     }
     
-    // Clean up world texture
+    // Clean up world atlas and page table
     if (m_device != VK_NULL_HANDLE) {
-        if (m_worldTexture.sampler != VK_NULL_HANDLE) {
-            vkDestroySampler(m_device, m_worldTexture.sampler, nullptr);
-        }
-        if (m_worldTexture.imageView != VK_NULL_HANDLE) {
-            vkDestroyImageView(m_device, m_worldTexture.imageView, nullptr);
-        }
-        if (m_worldTexture.image != VK_NULL_HANDLE) {
-            vkDestroyImage(m_device, m_worldTexture.image, nullptr);
-        }
-        if (m_worldTexture.memory != VK_NULL_HANDLE) {
-            vkFreeMemory(m_device, m_worldTexture.memory, nullptr);
-        }
+        destroyTexture(m_worldAtlas);
+        destroyTexture(m_pageTableTexture);
+        destroyTexture(m_lightMapTexture);
+        destroyTexture(m_minimapTexture);
+        destroyTexture(m_fogTexture);
+    }
+    
+    // Save the pipeline cache for the next launch
+    if (m_device != VK_NULL_HANDLE && m_pipelineCache != VK_NULL_HANDLE) {
+        savePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+        m_pipelineCache = VK_NULL_HANDLE;
+    }
+    
+    // Clean up the dynamic resolution render pass; its targets went with the swap chain
+    if (m_device != VK_NULL_HANDLE && m_scaledRenderPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(m_device, m_scaledRenderPass, nullptr);
+        m_scaledRenderPass = VK_NULL_HANDLE;
     }
     
     // Clean up command pool
@@ -320,10 +533,24 @@ void VulkanRenderer::cleanup() {
     }
 }
 
+void VulkanRenderer::waitForFrame() {
+    if (m_device == VK_NULL_HANDLE)
+        return;
+    
+    vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+}
+
 void VulkanRenderer::beginFrame() {
+    const auto acquireStart = std::chrono::high_resolution_clock::now();
+    
     // Wait for previous frame to complete
     vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
     
+    // The GPU is done with this frame's staging slice, readback and timestamps
+    m_stagingHead = 0;
+    finishCapture(m_captureReadbacks[m_currentFrame]);
+    readTimestamps(m_currentFrame);
+    
     // Acquire the next image from the swap chain
     VkResult result = vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX, 
                                           m_imageAvailableSemaphores[m_currentFrame], 
@@ -338,6 +565,17 @@ void VulkanRenderer::beginFrame() {
         throw std::runtime_error("Failed to acquire swap chain image!");
     }
     
+    m_recordStart = std::chrono::high_resolution_clock::now();
+    m_cpuAcquireTime.add(std::chrono::duration<double, std::milli>(m_recordStart - acquireStart).count());
+    
+    // Pick the size the world is drawn at this frame
+    m_renderScale = m_dynamicResolutionEnabled && !m_scaledTargets.empty() ? m_dynamicResolution.getScale() : 1.0f;
+    m_renderExtent = m_swapchainExtent;
+    if (m_renderScale < 1.0f) {
+        m_renderExtent.width = std::max(1u, static_cast<uint32_t>(m_swapchainExtent.width * m_renderScale));
+        m_renderExtent.height = std::max(1u, static_cast<uint32_t>(m_swapchainExtent.height * m_renderScale));
+    }
+    
     // Reset fence for current frame
     vkResetFences(m_device, 1, &m_inFlightFences[m_currentFrame]);
     
@@ -354,13 +592,31 @@ void VulkanRenderer::beginFrame() {
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
     
-    // Begin render pass
+    if (m_timestampPool != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(m_commandBuffers[m_currentFrame], m_timestampPool,
+                            static_cast<uint32_t>(m_currentFrame) * TIMESTAMPS_PER_FRAME, TIMESTAMPS_PER_FRAME);
+    }
+    writeTimestamp(TIMESTAMP_FRAME_START, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    
+    // Texture uploads are recorded next; the render pass starts once
+    // renderWorld has recorded them, since copies can't run inside it
+    m_frameActive = true;
+    m_renderPassActive = false;
+}
+
+void VulkanRenderer::beginRenderPass() {
+    // Uploads end here, once every copy and barrier before the pass is done
+    writeTimestamp(TIMESTAMP_UPLOADS_DONE, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    
+    // Below full scale, draw into the corner of this frame's offscreen target
+    const bool scaled = m_renderScale < 1.0f;
+    
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = m_renderPass;
-    renderPassInfo.framebuffer = m_swapchainFramebuffers[m_currentImageIndex];
+    renderPassInfo.renderPass = scaled ? m_scaledRenderPass : m_renderPass;
+    renderPassInfo.framebuffer = scaled ? m_scaledTargets[m_currentFrame].framebuffer : m_swapchainFramebuffers[m_currentImageIndex];
     renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = m_swapchainExtent;
+    renderPassInfo.renderArea.extent = m_renderExtent;
     
     // Set clear color
     VkClearValue clearColor = {{{m_clearColor[0], m_clearColor[1], m_clearColor[2], m_clearColor[3]}}};
@@ -376,33 +632,69 @@ void VulkanRenderer::beginFrame() {
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_swapchainExtent.width);
-    viewport.height = static_cast<float>(m_swapchainExtent.height);
+    viewport.width = static_cast<float>(m_renderExtent.width);
+    viewport.height = static_cast<float>(m_renderExtent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     vkCmdSetViewport(m_commandBuffers[m_currentFrame], 0, 1, &viewport);
     
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = m_swapchainExtent;
+    scissor.extent = m_renderExtent;
     vkCmdSetScissor(m_commandBuffers[m_currentFrame], 0, 1, &scissor);
+    
+    m_renderPassActive = true;
 }
 
 void VulkanRenderer::endFrame() {
+    // Nothing was recorded if beginFrame had to recreate the swap chain
+    if (!m_frameActive) {
+        if (m_pendingCapture) {
+            m_frameRecorder->releaseFrame(m_pendingCapture);
+            m_pendingCapture = nullptr;
+        }
+        return;
+    }
+    m_frameActive = false;
+    
+    // Still clear the screen when nothing was drawn
+    if (!m_renderPassActive)
+        beginRenderPass();
+    
     // End render pass
     vkCmdEndRenderPass(m_commandBuffers[m_currentFrame]);
+    m_renderPassActive = false;
+    writeTimestamp(TIMESTAMP_PASS_DONE, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    
+    if (m_renderScale < 1.0f)
+        blitScaledTarget();
+    
+    // Copy the finished image out for the recorder
+    if (m_pendingCapture) {
+        recordCapture(m_pendingCapture);
+        m_pendingCapture = nullptr;
+    }
+    
+    writeTimestamp(TIMESTAMP_FRAME_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    if (m_timestampPool != VK_NULL_HANDLE) {
+        m_timestampsWritten[m_currentFrame] = 1;
+    }
     
     // End command buffer recording
     if (vkEndCommandBuffer(m_commandBuffers[m_currentFrame]) != VK_SUCCESS) {
         throw std::runtime_error("Failed to record command buffer!");
     }
+    m_cpuRecordTime.add(std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - m_recordStart).count());
     
     // Submit command buffer
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     
     VkSemaphore waitSemaphores[] = {m_imageAvailableSemaphores[m_currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    // The swap chain image is first written by the render pass, or by the
+    // blit at reduced resolution
+    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT};
     submitInfo.waitSemaphoreCount = 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
@@ -429,7 +721,10 @@ void VulkanRenderer::endFrame() {
     presentInfo.pImageIndices = &m_currentImageIndex;
     presentInfo.pResults = nullptr;
     
+    const auto presentStart = std::chrono::high_resolution_clock::now();
     VkResult result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
+    m_cpuPresentTime.add(std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - presentStart).count());
     
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized) {
         m_framebufferResized = false;
@@ -442,9 +737,18 @@ void VulkanRenderer::endFrame() {
     m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
-void VulkanRenderer::renderWorld(const World& world, int cameraX, int cameraY, float zoomLevel) {
-    // First, update the world texture with camera information
-    updateWorldTexture(world, cameraX, cameraY, zoomLevel);
+void VulkanRenderer::renderWorld(const WorldSnapshot& snapshot, int cameraX, int cameraY, float zoomLevel) {
+    if (!m_frameActive)
+        return;
+    
+    // First, record the world texture and light map uploads with camera information
+    updateWorldTexture(snapshot, cameraX, cameraY, zoomLevel);
+    updateLightMap(snapshot, cameraX, cameraY);
+    updateMinimap(snapshot, cameraX, cameraY);
+    
+    // Uploads must land before the render pass that samples them
+    if (!m_renderPassActive)
+        beginRenderPass();
     
     // Then, update uniform buffer with camera information
     updateUniformBuffer(m_currentFrame, cameraX, cameraY, zoomLevel);
@@ -455,7 +759,7 @@ void VulkanRenderer::renderWorld(const World& world, int cameraX, int cameraY, f
         VK_PIPELINE_BIND_POINT_GRAPHICS,
         m_pipelineLayout,
         0, 1,
-        &m_descriptorSet,
+        &m_descriptorSets[m_currentFrame],
         0, nullptr
     );
     
@@ -467,26 +771,13 @@ void VulkanRenderer::renderWorld(const World& world, int cameraX, int cameraY, f
     // Bind the index buffer
     vkCmdBindIndexBuffer(m_commandBuffers[m_currentFrame], m_indexBuffer, 0, VK_INDEX_TYPE_UINT16);
     
-    // Push constant for material type (will be used for each different material)
-    struct PushConstants {
-        uint32_t materialType;
-    } constants;
-    
-    // Render each type of material - iterate through all materials in the database
-    for (uint32_t materialId = 1; materialId <= 10; materialId++) {
-        // Update push constants
-        constants.materialType = materialId;
-        vkCmdPushConstants(
-            m_commandBuffers[m_currentFrame],
-            m_pipelineLayout,
-            VK_SHADER_STAGE_FRAGMENT_BIT,
-            0,
-            sizeof(PushConstants),
-            &constants
-        );
-        
-        // Draw the quad
-        vkCmdDrawIndexed(m_commandBuffers[m_currentFrame], 6, 1, 0, 0, 0);
+    // Draw the quad; the shader looks up each cell's material in the palette
+    vkCmdDrawIndexed(m_commandBuffers[m_currentFrame], 6, 1, 0, 0, 0);
+    
+    // The minimap is the same quad as instance 1, which the shaders move
+    // into its corner and color from the minimap texture
+    if (m_minimapVisible) {
+        vkCmdDrawIndexed(m_commandBuffers[m_currentFrame], 6, 1, 0, 0, 1);
     }
     
     // Debug log periodically to show rendering is working
@@ -514,6 +805,15 @@ void VulkanRenderer::setViewport(int x, int y, int width, int height) {
     };
 }
 
+void VulkanRenderer::setPresentMode(VkPresentModeKHR mode) {
+    m_requestedPresentMode = mode;
+    
+    // An existing swap chain is rebuilt at the next frame
+    if (m_swapchain != VK_NULL_HANDLE && mode != m_presentMode) {
+        m_framebufferResized = true;
+    }
+}
+
 void VulkanRenderer::handleResize(int width, int height) {
     m_screenWidth = width;
     m_screenHeight = height;
@@ -886,9 +1186,8 @@ VkSurfaceFormatKHR VulkanRenderer::chooseSwapSurfaceFormat(const std::vector<VkS
 }
 
 VkPresentModeKHR VulkanRenderer::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-    // Prefer mailbox (triple buffering) if available
     for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (availablePresentMode == m_requestedPresentMode) {
             return availablePresentMode;
         }
     }
@@ -924,6 +1223,10 @@ bool VulkanRenderer::createSwapChain() {
     // Choose swap chain format, present mode and extent
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
     VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    if (presentMode != m_requestedPresentMode) {
+        std::cout << "Requested present mode is not supported, using FIFO" << std::endl;
+    }
+    m_presentMode = presentMode;
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
     
     // Determine how many images to use in the swap chain (one more than minimum for better performance)
@@ -946,6 +1249,29 @@ bool VulkanRenderer::createSwapChain() {
     createInfo.imageArrayLayers = 1; // Always 1 unless making stereoscopic 3D app
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     
+    // Frame recording copies straight out of the swap chain images, when
+    // the surface allows it and the pixels are plain 8-bit RGBA or BGRA
+    const bool transferSource = (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+    if (transferSource) {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    m_swapchainCapturable = transferSource && (
+        surfaceFormat.format == VK_FORMAT_B8G8R8A8_SRGB || surfaceFormat.format == VK_FORMAT_B8G8R8A8_UNORM ||
+        surfaceFormat.format == VK_FORMAT_R8G8B8A8_SRGB || surfaceFormat.format == VK_FORMAT_R8G8B8A8_UNORM
+    );
+    
+    // Dynamic resolution blits offscreen targets of the same format onto
+    // the swap chain images, with linear filtering
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, surfaceFormat.format, &formatProperties);
+    const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+    m_swapchainScalable = (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0 &&
+        (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+    if (m_swapchainScalable) {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+    
     // Handle queue families (if graphics and present are different)
     QueueFamilyIndices indices = findQueueFamilies(m_physicalDevice);
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily, indices.presentFamily};
@@ -1016,7 +1342,7 @@ bool VulkanRenderer::createImageViews() {
     return true;
 }
 
-VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
+VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
@@ -1032,7 +1358,7 @@ VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkIm
     // Subresource range describes what the image's purpose is
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
     
@@ -1091,13 +1417,38 @@ bool VulkanRenderer::createRenderPass() {
         return false;
     }
     
+    // The same pass for offscreen targets at reduced resolution: they end up
+    // ready for the blit, once the subpass's writes are done. Only layouts
+    // differ, so the passes stay compatible and share the pipeline.
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    
+    VkSubpassDependency scaledDependencies[2] = {dependency, {}};
+    scaledDependencies[1].srcSubpass = 0;
+    scaledDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    scaledDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    scaledDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    scaledDependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    scaledDependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = scaledDependencies;
+    
+    if (vkCreateRenderPass(m_device, &renderPassInfo, nullptr, &m_scaledRenderPass) != VK_SUCCESS) {
+        std::cerr << "Failed to create scaled render pass!" << std::endl;
+        return false;
+    }
+    
     return true;
 }
 
 bool VulkanRenderer::createDescriptorSetLayout() {
-    // We need two bindings:
+    // We need six bindings:
     // 1. Uniform buffer for camera and other parameters
-    // 2. Combined image sampler for the world texture
+    // 2. Combined image sampler for the world atlas
+    // 3. Combined image sampler for the page table
+    // 4. Uniform buffer for the material palette
+    // 5. Combined image sampler for the light map
+    // 6. Combined image sampler for the minimap
+    // 7. Combined image sampler for the fog of war masks
     
     // Uniform buffer binding
     VkDescriptorSetLayoutBinding uniformBinding{};
@@ -1107,7 +1458,7 @@ bool VulkanRenderer::createDescriptorSetLayout() {
     uniformBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT; // Access from both shaders
     uniformBinding.pImmutableSamplers = nullptr;
     
-    // Sampler binding for the world texture
+    // Sampler binding for the world atlas
     VkDescriptorSetLayoutBinding samplerBinding{};
     samplerBinding.binding = 1;
     samplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -1115,10 +1466,50 @@ bool VulkanRenderer::createDescriptorSetLayout() {
     samplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // Only access from fragment shader
     samplerBinding.pImmutableSamplers = nullptr;
     
-    // Combine both bindings
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uniformBinding, samplerBinding};
-    
-    // Create the descriptor set layout with both bindings
+    // Sampler binding for the page table
+    VkDescriptorSetLayoutBinding pageTableBinding{};
+    pageTableBinding.binding = 2;
+    pageTableBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pageTableBinding.descriptorCount = 1;
+    pageTableBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pageTableBinding.pImmutableSamplers = nullptr;
+    
+    // Material palette binding
+    VkDescriptorSetLayoutBinding paletteBinding{};
+    paletteBinding.binding = 3;
+    paletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    paletteBinding.descriptorCount = 1;
+    paletteBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    paletteBinding.pImmutableSamplers = nullptr;
+    
+    // Light map binding
+    VkDescriptorSetLayoutBinding lightMapBinding{};
+    lightMapBinding.binding = 4;
+    lightMapBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    lightMapBinding.descriptorCount = 1;
+    lightMapBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    lightMapBinding.pImmutableSamplers = nullptr;
+    
+    // Minimap binding
+    VkDescriptorSetLayoutBinding minimapBinding{};
+    minimapBinding.binding = 5;
+    minimapBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    minimapBinding.descriptorCount = 1;
+    minimapBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    minimapBinding.pImmutableSamplers = nullptr;
+    
+    // Fog of war binding
+    VkDescriptorSetLayoutBinding fogBinding{};
+    fogBinding.binding = 6;
+    fogBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    fogBinding.descriptorCount = 1;
+    fogBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fogBinding.pImmutableSamplers = nullptr;
+    
+    // Combine the bindings
+    std::array<VkDescriptorSetLayoutBinding, 7> bindings = {uniformBinding, samplerBinding, pageTableBinding, paletteBinding, lightMapBinding, minimapBinding, fogBinding};
+    
+    // Create the descriptor set layout with all bindings
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -1210,7 +1601,7 @@ bool VulkanRenderer::createGraphicsPipeline() {
         rasterizer.rasterizerDiscardEnable = VK_FALSE; // Don't discard geometry
         rasterizer.polygonMode = VK_POLYGON_MODE_FILL; // Fill triangles
         rasterizer.lineWidth = 1.0f; // Line width when drawing lines
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT; // Cull back faces
+        rasterizer.cullMode = VK_CULL_MODE_NONE; // The fullscreen quad winds clockwise in Vulkan's y-down space
         rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // Vertex order for front faces
         rasterizer.depthBiasEnable = VK_FALSE; // No depth bias
         
@@ -1250,19 +1641,12 @@ bool VulkanRenderer::createGraphicsPipeline() {
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates = dynamicStates.data();
         
-        // Setup push constants for passing material type to the shader
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // Only used in fragment shader
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(uint32_t); // One uint for material type
-        
         // Create the pipeline layout
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = 1;
         pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-        pipelineLayoutInfo.pushConstantRangeCount = 1; 
-        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
         
         if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             std::cerr << "Failed to create pipeline layout!" << std::endl;
@@ -1290,13 +1674,19 @@ bool VulkanRenderer::createGraphicsPipeline() {
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex = -1;
         
-        if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+        auto pipelineStart = std::chrono::high_resolution_clock::now();
+        if (vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
             std::cerr << "Failed to create graphics pipeline!" << std::endl;
             vkDestroyShaderModule(m_device, fragShaderModule, nullptr);
             vkDestroyShaderModule(m_device, vertShaderModule, nullptr);
             return false;
         }
         
+        auto pipelineEnd = std::chrono::high_resolution_clock::now();
+        std::cout << "Graphics pipeline created in "
+                  << std::chrono::duration<double, std::milli>(pipelineEnd - pipelineStart).count() << " ms"
+                  << (m_pipelineCache != VK_NULL_HANDLE ? "" : " (no pipeline cache)") << std::endl;
+        
         // Clean up shader modules, they're no longer needed after pipeline creation
         vkDestroyShaderModule(m_device, fragShaderModule, nullptr);
         vkDestroyShaderModule(m_device, vertShaderModule, nullptr);
@@ -1308,6 +1698,106 @@ bool VulkanRenderer::createGraphicsPipeline() {
     }
 }
 
+bool VulkanRenderer::createPipelineCache() {
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+    
+    // Reuse the saved cache only if it was written by this device and driver
+    // and arrived intact; drivers may not validate it thoroughly themselves
+    std::vector<char> data;
+    std::ifstream file(PIPELINE_CACHE_FILE, std::ios::binary);
+    if (file.is_open()) {
+        PipelineCacheFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        
+        bool valid = file.good()
+            && header.magic == PIPELINE_CACHE_MAGIC
+            && header.vendorID == deviceProperties.vendorID
+            && header.deviceID == deviceProperties.deviceID
+            && header.driverVersion == deviceProperties.driverVersion
+            && memcmp(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0
+            && header.dataSize >= sizeof(PipelineCacheBlobHeader);
+        
+        if (valid) {
+            data.resize(header.dataSize);
+            file.read(data.data(), data.size());
+            valid = file.good() && HashBytes(data.data(), data.size()) == header.dataHash;
+        }
+        
+        if (valid) {
+            PipelineCacheBlobHeader blobHeader;
+            memcpy(&blobHeader, data.data(), sizeof(blobHeader));
+            valid = blobHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                && blobHeader.vendorID == deviceProperties.vendorID
+                && blobHeader.deviceID == deviceProperties.deviceID
+                && memcmp(blobHeader.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+        
+        if (!valid) {
+            std::cout << "Ignoring stale or corrupt pipeline cache " << PIPELINE_CACHE_FILE << std::endl;
+            data.clear();
+        }
+    }
+    
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+    
+    if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+        m_pipelineCache = VK_NULL_HANDLE;
+        return false;
+    }
+    
+    std::cout << "Pipeline cache: " << (data.empty() ? "cold start" : std::to_string(data.size()) + " bytes loaded") << std::endl;
+    return true;
+}
+
+void VulkanRenderer::savePipelineCache() {
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
+    
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+        return;
+    data.resize(dataSize);
+    
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+    
+    PipelineCacheFileHeader header{};
+    header.magic = PIPELINE_CACHE_MAGIC;
+    header.dataSize = static_cast<uint32_t>(data.size());
+    header.dataHash = HashBytes(data.data(), data.size());
+    header.vendorID = deviceProperties.vendorID;
+    header.deviceID = deviceProperties.deviceID;
+    header.driverVersion = deviceProperties.driverVersion;
+    memcpy(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+    
+    // Write beside the old file and swap it in, so a crash can't leave half a cache
+    const std::string tempFile = std::string(PIPELINE_CACHE_FILE) + ".tmp";
+    {
+        std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file for pipeline cache: " << tempFile << std::endl;
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), data.size());
+        if (!file.good()) {
+            std::cerr << "Failed to write pipeline cache" << std::endl;
+            return;
+        }
+    }
+    
+    std::error_code error;
+    std::filesystem::rename(tempFile, PIPELINE_CACHE_FILE, error);
+    if (error) {
+        std::cerr << "Failed to save pipeline cache: " << error.message() << std::endl;
+    }
+}
+
 bool VulkanRenderer::createFramebuffers() {
     // Resize framebuffers array to match the number of swap chain image views
     m_swapchainFramebuffers.resize(m_swapchainImageViews.size());
@@ -1337,6 +1827,104 @@ bool VulkanRenderer::createFramebuffers() {
     return true;
 }
 
+bool VulkanRenderer::createScaledTargets() {
+    if (!m_swapchainScalable)
+        return false;
+    
+    m_scaledTargets.assign(MAX_FRAMES_IN_FLIGHT, ScaledTarget{});
+    try {
+        for (ScaledTarget& target : m_scaledTargets) {
+            createImage(m_swapchainExtent.width, m_swapchainExtent.height, 1, m_swapchainImageFormat, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, target.image, target.memory);
+            target.view = createImageView(target.image, m_swapchainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+            
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = m_scaledRenderPass;
+            framebufferInfo.attachmentCount = 1;
+            framebufferInfo.pAttachments = &target.view;
+            framebufferInfo.width = m_swapchainExtent.width;
+            framebufferInfo.height = m_swapchainExtent.height;
+            framebufferInfo.layers = 1;
+            
+            if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &target.framebuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create scaled framebuffer!");
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error creating dynamic resolution targets: " << e.what() << std::endl;
+        destroyScaledTargets();
+        return false;
+    }
+    
+    return true;
+}
+
+void VulkanRenderer::destroyScaledTargets() {
+    for (ScaledTarget& target : m_scaledTargets) {
+        if (target.framebuffer != VK_NULL_HANDLE) {
+            vkDestroyFramebuffer(m_device, target.framebuffer, nullptr);
+        }
+        if (target.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, target.view, nullptr);
+        }
+        if (target.image != VK_NULL_HANDLE) {
+            vkDestroyImage(m_device, target.image, nullptr);
+        }
+        if (target.memory != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device, target.memory, nullptr);
+        }
+    }
+    m_scaledTargets.clear();
+}
+
+void VulkanRenderer::blitScaledTarget() {
+    VkCommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
+    VkImage swapchainImage = m_swapchainImages[m_currentImageIndex];
+    
+    // The render pass already made the target ready to read; the swap chain
+    // image's old contents don't matter
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapchainImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+    
+    VkImageBlit blit{};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.mipLevel = 0;
+    blit.srcSubresource.baseArrayLayer = 0;
+    blit.srcSubresource.layerCount = 1;
+    blit.srcOffsets[0] = {0, 0, 0};
+    blit.srcOffsets[1] = {static_cast<int32_t>(m_renderExtent.width), static_cast<int32_t>(m_renderExtent.height), 1};
+    blit.dstSubresource = blit.srcSubresource;
+    blit.dstOffsets[0] = {0, 0, 0};
+    blit.dstOffsets[1] = {static_cast<int32_t>(m_swapchainExtent.width), static_cast<int32_t>(m_swapchainExtent.height), 1};
+    vkCmdBlitImage(commandBuffer,
+                   m_scaledTargets[m_currentFrame].image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   swapchainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   1, &blit, VK_FILTER_LINEAR);
+    
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
 bool VulkanRenderer::createCommandPool() {
     // Command pools manage the memory used to store command buffers
     // Command buffers submitted to the graphics queue should come from a pool created with the graphics queue family
@@ -1392,65 +1980,126 @@ void VulkanRenderer::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
     vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
 }
 
-bool VulkanRenderer::createWorldTexture(uint32_t width, uint32_t height) {
-    // Store texture dimensions
-    m_worldTexture.width = width;
-    m_worldTexture.height = height;
+bool VulkanRenderer::createWorldAtlas() {
+    const uint32_t atlasSize = ATLAS_PAGE_SIZE * ATLAS_PAGES_PER_ROW;
     
-    // Create the texture image
-    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM; // RGBA format for pixel data
+    // One byte per cell: the material ID, colored in the shader
+    if (!createSampledTexture(m_worldAtlas, atlasSize, atlasSize, VK_FORMAT_R8_UINT, ATLAS_MIP_LEVELS)) {
+        return false;
+    }
+    
+    m_atlasPages.assign(ATLAS_PAGE_COUNT, AtlasPage{glm::ivec2(0, 0), 0, 0, false});
+    m_chunkPages.clear();
+    return true;
+}
+
+bool VulkanRenderer::createPageTable() {
+    if (!createSampledTexture(m_pageTableTexture, PAGE_TABLE_SIZE, PAGE_TABLE_SIZE, VK_FORMAT_R32_UINT)) {
+        return false;
+    }
+    
+    // Empty, so the first frame uploads the whole table
+    m_pageTable.clear();
+    return true;
+}
+
+bool VulkanRenderer::createLightMap() {
+    // Smooth light between texels; integer formats couldn't be filtered
+    if (!createSampledTexture(m_lightMapTexture, LightMap::SIZE, LightMap::SIZE, VK_FORMAT_R8_UNORM, 1, VK_FILTER_LINEAR)) {
+        return false;
+    }
+    
+    // The first update sends the whole map
+    m_lightMapStale = true;
+    return true;
+}
+
+bool VulkanRenderer::createMinimap() {
+    if (!createSampledTexture(m_minimapTexture, Minimap::SIZE, Minimap::SIZE, VK_FORMAT_R8_UINT)) {
+        return false;
+    }
+    
+    m_minimapStale = true;
+    return true;
+}
+
+bool VulkanRenderer::createFogTexture() {
+    const uint32_t width = PAGE_TABLE_SIZE * FOG_TEXELS_PER_ROW;
+    const uint32_t height = PAGE_TABLE_SIZE * Chunk::CHUNK_SIZE;
+    if (!createSampledTexture(m_fogTexture, width, height, VK_FORMAT_R32_UINT)) {
+        return false;
+    }
+    
+    // Contents unknown until a block is first sent
+    m_fogMasks.clear();
+    m_fogBlockSent.clear();
+    return true;
+}
+
+bool VulkanRenderer::createSampledTexture(VulkanTexture& texture, uint32_t width, uint32_t height, VkFormat format,
+                                          uint32_t mipLevels, VkFilter filter) {
+    // Store texture dimensions
+    texture.width = width;
+    texture.height = height;
+    texture.mipLevels = mipLevels;
     
     // Create image
     createImage(
         width, height,
+        mipLevels,
         format,
         VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        m_worldTexture.image,
-        m_worldTexture.memory
+        texture.image,
+        texture.memory
     );
     
-    // Transition image layout to shader optimal
+    // Transition image layout to shader optimal; this only happens at startup
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
     transitionImageLayout(
-        m_worldTexture.image,
+        commandBuffer,
+        texture.image,
         format,
         VK_IMAGE_LAYOUT_UNDEFINED,
         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
     );
+    endSingleTimeCommands(commandBuffer);
     
     // Create image view
-    m_worldTexture.imageView = createImageView(
-        m_worldTexture.image,
+    texture.imageView = createImageView(
+        texture.image,
         format,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        mipLevels
     );
     
-    if (m_worldTexture.imageView == VK_NULL_HANDLE) {
+    if (texture.imageView == VK_NULL_HANDLE) {
         std::cerr << "Failed to create texture image view!" << std::endl;
         return false;
     }
     
-    // Create texture sampler
+    // Create texture sampler; most textures are read texel by texel, so
+    // nearest is the default
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_NEAREST; // Pixelated look for particle simulation
-    samplerInfo.minFilter = VK_FILTER_NEAREST;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = 16.0f;
+    samplerInfo.magFilter = filter;
+    samplerInfo.minFilter = filter;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE; // Integer formats can't be filtered
+    samplerInfo.maxAnisotropy = 1.0f;
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
     samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(mipLevels - 1);
     
-    if (vkCreateSampler(m_device, &samplerInfo, nullptr, &m_worldTexture.sampler) != VK_SUCCESS) {
+    if (vkCreateSampler(m_device, &samplerInfo, nullptr, &texture.sampler) != VK_SUCCESS) {
         std::cerr << "Failed to create texture sampler!" << std::endl;
         return false;
     }
@@ -1458,7 +2107,23 @@ bool VulkanRenderer::createWorldTexture(uint32_t width, uint32_t height) {
     return true;
 }
 
-void VulkanRenderer::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, 
+void VulkanRenderer::destroyTexture(VulkanTexture& texture) {
+    if (texture.sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(m_device, texture.sampler, nullptr);
+    }
+    if (texture.imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(m_device, texture.imageView, nullptr);
+    }
+    if (texture.image != VK_NULL_HANDLE) {
+        vkDestroyImage(m_device, texture.image, nullptr);
+    }
+    if (texture.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, texture.memory, nullptr);
+    }
+    texture = {};
+}
+
+void VulkanRenderer::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, 
                               VkImageUsageFlags usage, VkMemoryPropertyFlags properties, 
                               VkImage& image, VkDeviceMemory& imageMemory) {
     // Create the image
@@ -1468,7 +2133,7 @@ void VulkanRenderer::createImage(uint32_t width, uint32_t height, VkFormat forma
     imageInfo.extent.width = width;
     imageInfo.extent.height = height;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
@@ -1498,10 +2163,8 @@ void VulkanRenderer::createImage(uint32_t width, uint32_t height, VkFormat forma
     vkBindImageMemory(m_device, image, imageMemory, 0);
 }
 
-void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
+void VulkanRenderer::transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
     // Image layout transitions are performed using image memory barriers
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-    
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = oldLayout;
@@ -1511,7 +2174,7 @@ void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkIma
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS; // Every mip level changes layout together
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
     
@@ -1538,6 +2201,13 @@ void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkIma
         
         sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
         destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    } else if (oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        // Partial update: keep the contents, but wait for earlier frames to stop reading
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        
+        sourceStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     } else {
         throw std::invalid_argument("Unsupported layout transition!");
     }
@@ -1550,36 +2220,45 @@ void VulkanRenderer::transitionImageLayout(VkImage image, VkFormat format, VkIma
         0, nullptr,
         1, &barrier
     );
-    
-    endSingleTimeCommands(commandBuffer);
 }
 
-void VulkanRenderer::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-    
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    
-    region.imageOffset = {0, 0, 0};
-    region.imageExtent = {width, height, 1};
-    
+void VulkanRenderer::copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions) {
     vkCmdCopyBufferToImage(
         commandBuffer,
         buffer,
         image,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        1,
-        &region
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
     );
+}
+
+void VulkanRenderer::uploadStagedRegions(VkImage image, VkFormat format, const std::vector<VkBufferImageCopy>& regions) {
+    // Recorded into the frame's own command buffer ahead of the render pass,
+    // so uploads are submitted with the draw and never stall the CPU. The
+    // first barrier also waits for earlier frames to stop sampling the image.
+    VkCommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
+    
+    // Regions outside the copies keep their contents
+    transitionImageLayout(commandBuffer, image, format, 
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
     
-    endSingleTimeCommands(commandBuffer);
+    copyBufferToImage(commandBuffer, m_stagingBuffer, image, regions);
+    
+    transitionImageLayout(commandBuffer, image, format, 
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+VkDeviceSize VulkanRenderer::allocateStaging(VkDeviceSize size) {
+    // 16-byte steps keep every copy's buffer offset texel aligned
+    const VkDeviceSize offset = (m_stagingHead + 15) & ~VkDeviceSize(15);
+    if (offset + size > STAGING_FRAME_SIZE)
+        return VK_WHOLE_SIZE;
+    
+    m_stagingHead = offset + size;
+    return m_currentFrame * STAGING_FRAME_SIZE + offset;
 }
 
 bool VulkanRenderer::createVertexBuffer() {
@@ -1735,28 +2414,336 @@ bool VulkanRenderer::createIndexBuffer() {
     }
 }
 
-bool VulkanRenderer::createUniformBuffer() {
-    // Define a uniform buffer for passing information to the shaders
-    // This will hold camera position, zoom level, and other global parameters
+bool VulkanRenderer::createUniformBuffers() {
+    // One uniform buffer per frame in flight, so updating this frame's
+    // parameters never touches a buffer the GPU may still be reading
+    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+    
+    m_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    m_uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    m_uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT, nullptr);
+    
+    try {
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            createBuffer(
+                bufferSize,
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                m_uniformBuffers[i],
+                m_uniformBuffersMemory[i]
+            );
+            
+            // Coherent memory stays mapped; writes need no flush
+            vkMapMemory(m_device, m_uniformBuffersMemory[i], 0, bufferSize, 0, &m_uniformBuffersMapped[i]);
+        }
+        
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error creating uniform buffers: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool VulkanRenderer::createPaletteBuffer() {
+    // Unknown material IDs keep a zero entry and render transparent
+    std::vector<PaletteEntry> palette(PALETTE_SIZE, PaletteEntry{glm::vec4(0.0f), glm::vec4(0.0f)});
+    
+    const MaterialDatabase& materials = MaterialDatabase::Get();
+    for (uint32_t id = 1; id < PALETTE_SIZE; id++) {
+        if (!materials.HasMaterial(static_cast<uint8_t>(id)))
+            continue;
+        
+        const Material& material = materials.GetMaterial(static_cast<uint8_t>(id));
+        PaletteEntry& entry = palette[id];
+        entry.color = material.color;
+        entry.effects.x = material.isSolid ? 0.1f : 0.0f;
+        entry.effects.y = material.isLiquid ? 1.0f : 0.0f;
+        entry.effects.z = material.emissive;
+        
+        // Emissive liquids pulse slowly instead of flickering like flames
+        entry.effects.w = (material.emissive > 0.0f && !material.isLiquid) ? 0.4f : 0.0f;
+    }
     
-    // Align to the size of vec4 (16 bytes) for better performance
-    // The buffer will contain: cameraX, cameraY, zoomLevel, time + any other parameters we need
-    VkDeviceSize bufferSize = sizeof(float) * 16; // Reserve space for 4 vec4s
+    const VkDeviceSize bufferSize = sizeof(PaletteEntry) * PALETTE_SIZE;
     
     try {
         createBuffer(
             bufferSize,
             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            m_uniformBuffer,
-            m_uniformBufferMemory
+            m_paletteBuffer,
+            m_paletteBufferMemory
+        );
+        
+        void* data;
+        vkMapMemory(m_device, m_paletteBufferMemory, 0, bufferSize, 0, &data);
+        memcpy(data, palette.data(), static_cast<size_t>(bufferSize));
+        vkUnmapMemory(m_device, m_paletteBufferMemory);
+        
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error creating material palette: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool VulkanRenderer::createStagingBuffer() {
+    const VkDeviceSize bufferSize = STAGING_FRAME_SIZE * MAX_FRAMES_IN_FLIGHT;
+    
+    try {
+        createBuffer(
+            bufferSize,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            m_stagingBuffer,
+            m_stagingBufferMemory
         );
         
+        void* data;
+        vkMapMemory(m_device, m_stagingBufferMemory, 0, bufferSize, 0, &data);
+        m_stagingMapped = static_cast<uint8_t*>(data);
+        m_stagingHead = 0;
+        
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Error creating uniform buffer: " << e.what() << std::endl;
+        std::cerr << "Error creating staging buffer: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool VulkanRenderer::createTimestampQueries() {
+    // Timestamps need a graphics queue that counts them and a known tick length
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &deviceProperties);
+    
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+    
+    const uint32_t validBits = queueFamilies[findQueueFamilies(m_physicalDevice).graphicsFamily].timestampValidBits;
+    if (validBits == 0 || deviceProperties.limits.timestampPeriod <= 0.0f)
+        return false;
+    
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MAX_FRAMES_IN_FLIGHT * TIMESTAMPS_PER_FRAME;
+    
+    if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_timestampPool) != VK_SUCCESS) {
+        m_timestampPool = VK_NULL_HANDLE;
         return false;
     }
+    
+    m_timestampPeriod = deviceProperties.limits.timestampPeriod;
+    m_timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+    return true;
+}
+
+void VulkanRenderer::writeTimestamp(FrameTimestamp timestamp, VkPipelineStageFlagBits stage) {
+    if (m_timestampPool == VK_NULL_HANDLE)
+        return;
+    
+    vkCmdWriteTimestamp(m_commandBuffers[m_currentFrame], stage, m_timestampPool,
+                        static_cast<uint32_t>(m_currentFrame) * TIMESTAMPS_PER_FRAME + timestamp);
+}
+
+void VulkanRenderer::readTimestamps(size_t frame) {
+    if (m_timestampPool == VK_NULL_HANDLE || !m_timestampsWritten[frame])
+        return;
+    m_timestampsWritten[frame] = 0;
+    
+    // The frame's fence has signaled, so the results are ready
+    std::array<uint64_t, TIMESTAMPS_PER_FRAME> ticks;
+    if (vkGetQueryPoolResults(m_device, m_timestampPool, static_cast<uint32_t>(frame) * TIMESTAMPS_PER_FRAME,
+                              TIMESTAMPS_PER_FRAME, sizeof(ticks), ticks.data(), sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        return;
+    }
+    
+    // Masking handles counters that wrapped within the frame
+    auto elapsedMs = [&](FrameTimestamp from, FrameTimestamp to) {
+        return static_cast<double>((ticks[to] - ticks[from]) & m_timestampMask) * m_timestampPeriod / 1.0e6;
+    };
+    m_gpuUploadTime.add(elapsedMs(TIMESTAMP_FRAME_START, TIMESTAMP_UPLOADS_DONE));
+    m_gpuDrawTime.add(elapsedMs(TIMESTAMP_UPLOADS_DONE, TIMESTAMP_PASS_DONE));
+    m_gpuPostPassTime.add(elapsedMs(TIMESTAMP_PASS_DONE, TIMESTAMP_FRAME_END));
+    m_gpuFrameTime.add(elapsedMs(TIMESTAMP_FRAME_START, TIMESTAMP_FRAME_END));
+    
+    if (m_dynamicResolutionEnabled) {
+        m_dynamicResolution.addFrameTime(static_cast<float>(elapsedMs(TIMESTAMP_FRAME_START, TIMESTAMP_FRAME_END)));
+    }
+}
+
+RenderTimings VulkanRenderer::getRenderTimings() const {
+    RenderTimings timings;
+    timings.gpuUpload = m_gpuUploadTime.get();
+    timings.gpuDraw = m_gpuDrawTime.get();
+    timings.gpuPostPass = m_gpuPostPassTime.get();
+    timings.gpuFrame = m_gpuFrameTime.get();
+    timings.cpuAcquire = m_cpuAcquireTime.get();
+    timings.cpuRecord = m_cpuRecordTime.get();
+    timings.cpuPresent = m_cpuPresentTime.get();
+    timings.samples = m_gpuFrameTime.getCount();
+    timings.gpuTimestamps = m_timestampPool != VK_NULL_HANDLE;
+    timings.renderScale = m_renderScale;
+    timings.atlasTiles = m_atlasTileUploads.get();
+    timings.atlasRegions = m_atlasRegionUploads.get();
+    timings.atlasDeferredChunks = m_atlasDeferredChunks.get();
+    timings.atlasResidentPages = static_cast<uint32_t>(m_chunkPages.size());
+    return timings;
+}
+
+void VulkanRenderer::setDynamicResolution(bool enabled, float budgetMs) {
+    // The controller is fed from GPU timestamps
+    m_dynamicResolutionEnabled = enabled && m_timestampPool != VK_NULL_HANDLE;
+    m_dynamicResolution.setBudget(budgetMs);
+    if (!m_dynamicResolutionEnabled) {
+        m_dynamicResolution.reset();
+    }
+}
+
+void VulkanRenderer::captureFrame(CapturedFrame* frame) {
+    // Recorded in endFrame, after the render pass
+    if (m_pendingCapture) {
+        m_frameRecorder->releaseFrame(m_pendingCapture);
+    }
+    m_pendingCapture = frame;
+}
+
+void VulkanRenderer::recordCapture(CapturedFrame* frame) {
+    CaptureReadback& readback = m_captureReadbacks[m_currentFrame];
+    const VkDeviceSize size = static_cast<VkDeviceSize>(m_swapchainExtent.width) * m_swapchainExtent.height * 4;
+    if (!m_swapchainCapturable || !ensureCaptureReadback(readback, size)) {
+        m_frameRecorder->releaseFrame(frame);
+        return;
+    }
+    
+    VkCommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
+    VkImage image = m_swapchainImages[m_currentImageIndex];
+    
+    // The render pass or the scaling blit left the image ready to present;
+    // copy it out, then put it back
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {m_swapchainExtent.width, m_swapchainExtent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+    
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+    
+    // Make the copy visible to the host once the fence signals
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = readback.buffer;
+    hostBarrier.offset = 0;
+    hostBarrier.size = size;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+    
+    frame->width = static_cast<int>(m_swapchainExtent.width);
+    frame->height = static_cast<int>(m_swapchainExtent.height);
+    frame->bgra = m_swapchainImageFormat == VK_FORMAT_B8G8R8A8_SRGB || m_swapchainImageFormat == VK_FORMAT_B8G8R8A8_UNORM;
+    readback.frame = frame;
+}
+
+void VulkanRenderer::finishCapture(CaptureReadback& readback) {
+    if (!readback.frame)
+        return;
+    
+    CapturedFrame* frame = readback.frame;
+    readback.frame = nullptr;
+    
+    // Host-cached memory may not be coherent
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = readback.memory;
+    range.offset = 0;
+    range.size = VK_WHOLE_SIZE;
+    vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+    
+    frame->pixels.resize(static_cast<size_t>(frame->width) * frame->height * 4);
+    std::memcpy(frame->pixels.data(), readback.mapped, frame->pixels.size());
+    m_frameRecorder->submitFrame(frame);
+}
+
+bool VulkanRenderer::ensureCaptureReadback(CaptureReadback& readback, VkDeviceSize size) {
+    if (readback.buffer != VK_NULL_HANDLE && readback.size >= size)
+        return true;
+    
+    // Only called for the current frame, whose previous copy has finished
+    destroyCaptureReadback(readback);
+    
+    // Cached memory makes the CPU copy fast; not every device has it
+    try {
+        try {
+            createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                         readback.buffer, readback.memory);
+        } catch (const std::exception&) {
+            destroyCaptureReadback(readback);
+            createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         readback.buffer, readback.memory);
+        }
+        
+        void* data;
+        if (vkMapMemory(m_device, readback.memory, 0, size, 0, &data) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map readback buffer!");
+        }
+        readback.mapped = static_cast<uint8_t*>(data);
+        readback.size = size;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error creating frame readback buffer: " << e.what() << std::endl;
+        destroyCaptureReadback(readback);
+        return false;
+    }
+}
+
+void VulkanRenderer::destroyCaptureReadback(CaptureReadback& readback) {
+    if (readback.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, readback.buffer, nullptr);
+    }
+    if (readback.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device, readback.memory, nullptr);
+    }
+    readback.buffer = VK_NULL_HANDLE;
+    readback.memory = VK_NULL_HANDLE;
+    readback.mapped = nullptr;
+    readback.size = 0;
 }
 
 bool VulkanRenderer::createDescriptorPool() {
@@ -1766,20 +2753,21 @@ bool VulkanRenderer::createDescriptorPool() {
     // Define the descriptor types we need and how many of each
     std::array<VkDescriptorPoolSize, 2> poolSizes{};
     
-    // Uniform buffer descriptor
+    // Uniform buffer descriptors (frame parameters and material palette)
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[0].descriptorCount = 1;
+    poolSizes[0].descriptorCount = 2 * MAX_FRAMES_IN_FLIGHT;
     
-    // Combined image sampler descriptor (for the world texture)
+    // Combined image sampler descriptors (world atlas, page table, light map,
+    // minimap and fog of war)
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = 1;
+    poolSizes[1].descriptorCount = 5 * MAX_FRAMES_IN_FLIGHT;
     
     // Create the descriptor pool
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 1; // We only need one descriptor set for now
+    poolInfo.maxSets = MAX_FRAMES_IN_FLIGHT; // One descriptor set per frame in flight
     
     if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
         std::cerr << "Failed to create descriptor pool!" << std::endl;
@@ -1791,57 +2779,135 @@ bool VulkanRenderer::createDescriptorPool() {
 
 bool VulkanRenderer::createDescriptorSets() {
     // A descriptor set is a collection of resources bound to the shader
-    // We need to allocate a descriptor set from the pool, and then fill it with our resources
+    // Each frame in flight gets its own set, pointing at its own uniform buffer
     
-    // Allocate a descriptor set
+    // Allocate the descriptor sets
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_descriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &m_descriptorSetLayout;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+    allocInfo.pSetLayouts = layouts.data();
     
-    if (vkAllocateDescriptorSets(m_device, &allocInfo, &m_descriptorSet) != VK_SUCCESS) {
-        std::cerr << "Failed to allocate descriptor set!" << std::endl;
+    m_descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    if (vkAllocateDescriptorSets(m_device, &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+        std::cerr << "Failed to allocate descriptor sets!" << std::endl;
         return false;
     }
     
-    // Update the descriptor set with our actual resources
-    
-    // First descriptor is the uniform buffer
-    VkDescriptorBufferInfo bufferInfo{};
-    bufferInfo.buffer = m_uniformBuffer;
-    bufferInfo.offset = 0;
-    bufferInfo.range = VK_WHOLE_SIZE; // The entire buffer
-    
-    // Second descriptor is the world texture
-    VkDescriptorImageInfo imageInfo{};
-    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    imageInfo.imageView = m_worldTexture.imageView;
-    imageInfo.sampler = m_worldTexture.sampler;
-    
-    // Descriptor write operations
-    std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-    
-    // Uniform buffer descriptor
-    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[0].dstSet = m_descriptorSet;
-    descriptorWrites[0].dstBinding = 0; // Binding point in the shader
-    descriptorWrites[0].dstArrayElement = 0;
-    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorWrites[0].descriptorCount = 1;
-    descriptorWrites[0].pBufferInfo = &bufferInfo;
-    
-    // Image sampler descriptor
-    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrites[1].dstSet = m_descriptorSet;
-    descriptorWrites[1].dstBinding = 1; // Binding point in the shader
-    descriptorWrites[1].dstArrayElement = 0;
-    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorWrites[1].descriptorCount = 1;
-    descriptorWrites[1].pImageInfo = &imageInfo;
-    
-    // Update the descriptor set
-    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    // Update the descriptor sets with our actual resources
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        // First descriptor is this frame's uniform buffer
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = m_uniformBuffers[i];
+        bufferInfo.offset = 0;
+        bufferInfo.range = sizeof(UniformBufferObject);
+        
+        // Second descriptor is the world atlas
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = m_worldAtlas.imageView;
+        imageInfo.sampler = m_worldAtlas.sampler;
+        
+        // Third descriptor is the page table
+        VkDescriptorImageInfo pageTableInfo{};
+        pageTableInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        pageTableInfo.imageView = m_pageTableTexture.imageView;
+        pageTableInfo.sampler = m_pageTableTexture.sampler;
+        
+        // Fourth descriptor is the material palette, shared by every frame
+        VkDescriptorBufferInfo paletteInfo{};
+        paletteInfo.buffer = m_paletteBuffer;
+        paletteInfo.offset = 0;
+        paletteInfo.range = sizeof(PaletteEntry) * PALETTE_SIZE;
+        
+        // Fifth descriptor is the light map
+        VkDescriptorImageInfo lightMapInfo{};
+        lightMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        lightMapInfo.imageView = m_lightMapTexture.imageView;
+        lightMapInfo.sampler = m_lightMapTexture.sampler;
+        
+        // Sixth descriptor is the minimap
+        VkDescriptorImageInfo minimapInfo{};
+        minimapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        minimapInfo.imageView = m_minimapTexture.imageView;
+        minimapInfo.sampler = m_minimapTexture.sampler;
+        
+        // Seventh descriptor is the fog of war masks
+        VkDescriptorImageInfo fogInfo{};
+        fogInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        fogInfo.imageView = m_fogTexture.imageView;
+        fogInfo.sampler = m_fogTexture.sampler;
+        
+        // Descriptor write operations
+        std::array<VkWriteDescriptorSet, 7> descriptorWrites{};
+        
+        // Uniform buffer descriptor
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = m_descriptorSets[i];
+        descriptorWrites[0].dstBinding = 0; // Binding point in the shader
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+        
+        // Image sampler descriptor
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = m_descriptorSets[i];
+        descriptorWrites[1].dstBinding = 1; // Binding point in the shader
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pImageInfo = &imageInfo;
+        
+        // Page table descriptor
+        descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[2].dstSet = m_descriptorSets[i];
+        descriptorWrites[2].dstBinding = 2;
+        descriptorWrites[2].dstArrayElement = 0;
+        descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[2].descriptorCount = 1;
+        descriptorWrites[2].pImageInfo = &pageTableInfo;
+        
+        // Material palette descriptor
+        descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[3].dstSet = m_descriptorSets[i];
+        descriptorWrites[3].dstBinding = 3;
+        descriptorWrites[3].dstArrayElement = 0;
+        descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        descriptorWrites[3].descriptorCount = 1;
+        descriptorWrites[3].pBufferInfo = &paletteInfo;
+        
+        // Light map descriptor
+        descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[4].dstSet = m_descriptorSets[i];
+        descriptorWrites[4].dstBinding = 4;
+        descriptorWrites[4].dstArrayElement = 0;
+        descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[4].descriptorCount = 1;
+        descriptorWrites[4].pImageInfo = &lightMapInfo;
+        
+        // Minimap descriptor
+        descriptorWrites[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[5].dstSet = m_descriptorSets[i];
+        descriptorWrites[5].dstBinding = 5;
+        descriptorWrites[5].dstArrayElement = 0;
+        descriptorWrites[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[5].descriptorCount = 1;
+        descriptorWrites[5].pImageInfo = &minimapInfo;
+        
+        // Fog of war descriptor
+        descriptorWrites[6].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[6].dstSet = m_descriptorSets[i];
+        descriptorWrites[6].dstBinding = 6;
+        descriptorWrites[6].dstArrayElement = 0;
+        descriptorWrites[6].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[6].descriptorCount = 1;
+        descriptorWrites[6].pImageInfo = &fogInfo;
+        
+        // Update the descriptor set
+        vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
     
     return true;
 }
@@ -1899,6 +2965,9 @@ bool VulkanRenderer::createSyncObjects() {
 }
 
 void VulkanRenderer::cleanupSwapChain() {
+    // Destroy dynamic resolution targets, sized like the swap chain
+    destroyScaledTargets();
+    
     // Destroy framebuffers
     for (auto framebuffer : m_swapchainFramebuffers) {
         vkDestroyFramebuffer(m_device, framebuffer, nullptr);
@@ -1932,153 +3001,576 @@ void VulkanRenderer::recreateSwapChain() {
     createSwapChain();
     createImageViews();
     createFramebuffers();
+    createScaledTargets();
     
     // Update screen dimensions
     m_screenWidth = width;
     m_screenHeight = height;
 }
 
-void VulkanRenderer::updateWorldTexture(const World& world, int cameraX, int cameraY, float zoomLevel) {
-    // Create a temporary buffer with world texture data
-    const uint32_t width = m_worldTexture.width;
-    const uint32_t height = m_worldTexture.height;
-    const VkDeviceSize bufferSize = width * height * 4; // RGBA = 4 bytes per pixel
+// Floor division, so negative world coordinates land in the right chunk
+static int FloorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+// Number of set bits
+static int CountBits(uint64_t bits) {
+    int count = 0;
+    while (bits != 0) {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+}
+
+// Most common of four materials; ties go to a non-empty material, so thin
+// features survive downsampling
+static uint8_t RepresentativeMaterial(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    const uint8_t candidates[4] = { a, b, c, d };
+    uint8_t best = 0;
+    int bestCount = 0;
+    for (uint8_t material : candidates) {
+        const int count = (material == a) + (material == b) + (material == c) + (material == d);
+        if (count > bestCount || (count == bestCount && best == 0 && material != 0)) {
+            best = material;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+// Halve a tightly packed block of material IDs in both directions
+static void DownsampleMaterials(const uint8_t* source, int width, int height, uint8_t* out) {
+    for (int y = 0; y < height; y += 2) {
+        const uint8_t* top = source + y * width;
+        const uint8_t* bottom = top + width;
+        for (int x = 0; x < width; x += 2) {
+            *out++ = RepresentativeMaterial(top[x], top[x + 1], bottom[x], bottom[x + 1]);
+        }
+    }
+}
+
+void VulkanRenderer::updateWorldTexture(const WorldSnapshot& snapshot, int cameraX, int cameraY, float zoomLevel) {
+    const int chunkSize = Chunk::CHUNK_SIZE;
+    const int tileSize = Chunk::RENDER_TILE_SIZE;
+    const int tilesPerRow = chunkSize / tileSize;
+    
+    m_atlasFrame++;
+    
+    // Chunks under the screen; the camera is at the center
+    const float halfWidth = m_swapchainExtent.width * 0.5f / zoomLevel;
+    const float halfHeight = m_swapchainExtent.height * 0.5f / zoomLevel;
+    glm::ivec2 minChunk(
+        FloorDiv(static_cast<int>(std::floor(cameraX - halfWidth)), chunkSize),
+        FloorDiv(static_cast<int>(std::floor(cameraY - halfHeight)), chunkSize)
+    );
+    glm::ivec2 maxChunk(
+        FloorDiv(static_cast<int>(std::ceil(cameraX + halfWidth)), chunkSize),
+        FloorDiv(static_cast<int>(std::ceil(cameraY + halfHeight)), chunkSize)
+    );
+    
+    // Anything past the page table window can't be drawn anyway; when the
+    // view is wider than the window, keep the window around the camera
+    if (maxChunk.x - minChunk.x + 1 > PAGE_TABLE_SIZE) {
+        minChunk.x = FloorDiv(cameraX, chunkSize) - PAGE_TABLE_SIZE / 2;
+        maxChunk.x = minChunk.x + PAGE_TABLE_SIZE - 1;
+    }
+    if (maxChunk.y - minChunk.y + 1 > PAGE_TABLE_SIZE) {
+        minChunk.y = FloorDiv(cameraY, chunkSize) - PAGE_TABLE_SIZE / 2;
+        maxChunk.y = minChunk.y + PAGE_TABLE_SIZE - 1;
+    }
+    
+    // One material byte per cell, for every mip level of the tile
+    VkDeviceSize tileBytes = 0;
+    for (uint32_t level = 0; level < ATLAS_MIP_LEVELS; level++) {
+        tileBytes += (tileSize >> level) * (tileSize >> level);
+    }
     
-    // Create pixel buffer for the world texture
-    std::vector<uint8_t> pixels(width * height * 4, 0);
+    // Reserve staging for the whole page table before any page changes
+    // hands, so the table always goes up along with the pages it points to.
+    // Without room, nothing changes and the old table stays right for the
+    // old pages; try again next frame.
+    const VkDeviceSize tableOffset = allocateStaging(PAGE_TABLE_SIZE * PAGE_TABLE_SIZE * sizeof(uint32_t));
+    if (tableOffset == VK_WHOLE_SIZE) {
+        m_atlasTileUploads.add(0.0);
+        m_atlasRegionUploads.add(0.0);
+        m_atlasDeferredChunks.add((maxChunk.x - minChunk.x + 1) * (maxChunk.y - minChunk.y + 1));
+        return;
+    }
     
-    // Count the number of non-empty pixels for debugging
-    int nonEmptyPixels = 0;
+    std::vector<uint32_t>& pageTable = m_pageTableScratch;
+    pageTable.assign(PAGE_TABLE_SIZE * PAGE_TABLE_SIZE, 0);
+    m_atlasRegions.clear();
+    m_atlasEncodeJobs.clear();
+    int uploadedTiles = 0;
+    int deferredChunks = 0;
     
-    // Fill the pixel buffer with actual world data
-    for (uint32_t y = 0; y < height; y++) {
-        for (uint32_t x = 0; x < width; x++) {
-            uint32_t pixelIndex = (y * width + x) * 4;
+    for (int chunkY = minChunk.y; chunkY <= maxChunk.y; chunkY++) {
+        for (int chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++) {
+            glm::ivec2 coord(chunkX, chunkY);
+            const ChunkSnapshot* chunk = snapshot.GetChunk(coord);
+            auto pageIt = m_chunkPages.find(coord);
+            
+            if (!chunk) {
+                // Unloaded since we last drew it
+                if (pageIt != m_chunkPages.end()) {
+                    m_atlasPages[pageIt->second].inUse = false;
+                    m_chunkPages.erase(pageIt);
+                }
+                continue;
+            }
             
-            // Convert screen coordinates to world coordinates
-            // The camera coordinates should be at the center of the screen
-            // Adjust for zoom level and offset from center
-            int screenCenterX = width / 2;
-            int screenCenterY = height / 2;
-            int offsetX = x - screenCenterX;
-            int offsetY = y - screenCenterY;
+            uint32_t page;
+            bool newPage = false;
+            if (pageIt != m_chunkPages.end()) {
+                page = pageIt->second;
+            } else {
+                page = acquireAtlasPage(coord);
+                if (page == NO_ATLAS_PAGE)
+                    continue;
+                newPage = true;
+            }
             
-            // Calculate world coordinates based on camera position and zoom
-            int worldX = cameraX + static_cast<int>(offsetX / zoomLevel);
-            int worldY = cameraY + static_cast<int>(offsetY / zoomLevel);
+            // Tiles that changed after the page was filled; a new page holds
+            // someone else's pixels and has an uploaded tick of 0
+            uint64_t dirtyTiles = 0;
+            if (chunk->changedTick > m_atlasPages[page].uploadedTick) {
+                for (int tile = 0; tile < ChunkSnapshot::TILE_COUNT; tile++) {
+                    if (chunk->tileTicks[tile] > m_atlasPages[page].uploadedTick) {
+                        dirtyTiles |= uint64_t(1) << tile;
+                    }
+                }
+            }
             
-            // Get the particle at this position
-            auto particle = world.GetParticle(worldX, worldY);
+            // Reserve staging for every dirty tile; runs are laid out back to back
+            VkDeviceSize stagingOffset = 0;
+            if (dirtyTiles != 0) {
+                stagingOffset = allocateStaging(CountBits(dirtyTiles) * tileBytes);
+            }
             
-            if (!particle.IsEmpty()) {
-                nonEmptyPixels++;
-                
-                // Get material info
-                const auto& material = MaterialDatabase::Get().GetMaterial(particle.materialID);
-                
-                // Use very visible colors - bright red for all particles for now
-                pixels[pixelIndex + 0] = 255; // R - Bright red regardless of material
-                pixels[pixelIndex + 1] = 0;   // G
-                pixels[pixelIndex + 2] = 0;   // B
-                pixels[pixelIndex + 3] = 255; // A - fully opaque
-                
-                // Print the first few particles for debug
-                static int debugCount = 0;
-                if (debugCount < 5) {
-                    std::cout << "DEBUG: Set pixel at (" << x << "," << y << ") to material " 
-                              << (int)particle.materialID << " (R=" << (int)pixels[pixelIndex+0]
-                              << ", G=" << (int)pixels[pixelIndex+1]
-                              << ", B=" << (int)pixels[pixelIndex+2]
-                              << ", A=" << (int)pixels[pixelIndex+3] << ")" << std::endl;
-                    debugCount++;
+            // Out of staging space: try again next frame. A page that was
+            // never filled isn't shown until it is.
+            if (stagingOffset == VK_WHOLE_SIZE) {
+                deferredChunks++;
+                if (newPage) {
+                    m_atlasPages[page].inUse = false;
+                    m_chunkPages.erase(coord);
+                    continue;
                 }
+                dirtyTiles = 0;
             } else {
-                // Empty space - use a faint grid for visibility
-                if ((x % 64 == 0) || (y % 64 == 0)) {
-                    // Draw faint grid lines
-                    pixels[pixelIndex + 0] = 50;  // R
-                    pixels[pixelIndex + 1] = 50;  // G
-                    pixels[pixelIndex + 2] = 50;  // B
-                    pixels[pixelIndex + 3] = 50;  // A - semi-transparent
-                } else {
-                    // Empty space - transparent black
-                    pixels[pixelIndex + 0] = 0;    // R
-                    pixels[pixelIndex + 1] = 0;    // G
-                    pixels[pixelIndex + 2] = 0;    // B
-                    pixels[pixelIndex + 3] = 0;    // A (transparent)
+                m_atlasPages[page].uploadedTick = chunk->capturedTick;
+            }
+            
+            m_atlasPages[page].lastUsedFrame = m_atlasFrame;
+            // The table wraps around, so the slot is the coordinate mod its size
+            const int slotX = chunkX & (PAGE_TABLE_SIZE - 1);
+            const int slotY = chunkY & (PAGE_TABLE_SIZE - 1);
+            pageTable[slotY * PAGE_TABLE_SIZE + slotX] = page + 1;
+            
+            if (dirtyTiles == 0)
+                continue;
+            
+            const int32_t pageX = static_cast<int32_t>((page % ATLAS_PAGES_PER_ROW) * ATLAS_PAGE_SIZE);
+            const int32_t pageY = static_cast<int32_t>((page / ATLAS_PAGES_PER_ROW) * ATLAS_PAGE_SIZE);
+            
+            AtlasEncodeJob job;
+            job.chunk = chunk;
+            job.pageOrigin = glm::ivec2(pageX, pageY);
+            job.firstRegion = static_cast<uint32_t>(m_atlasRegions.size());
+            
+            // Each run of dirty tiles along a tile row becomes one copy region
+            for (int tileY = 0; tileY < tilesPerRow; tileY++) {
+                const uint64_t rowBits = dirtyTiles >> (tileY * tilesPerRow);
+                int tileX = 0;
+                while (tileX < tilesPerRow) {
+                    if (!((rowBits >> tileX) & 1)) {
+                        tileX++;
+                        continue;
+                    }
+                    
+                    const int runStart = tileX;
+                    while (tileX < tilesPerRow && ((rowBits >> tileX) & 1)) {
+                        tileX++;
+                    }
+                    
+                    const int startX = runStart * tileSize;
+                    const int width = (tileX - runStart) * tileSize;
+                    const int startY = tileY * tileSize;
+                    
+                    // One region per mip level, in level order; tiles stay
+                    // texel aligned down to the last level
+                    for (uint32_t level = 0; level < ATLAS_MIP_LEVELS; level++) {
+                        const int levelWidth = width >> level;
+                        const int levelHeight = tileSize >> level;
+                        
+                        VkBufferImageCopy region{};
+                        region.bufferOffset = stagingOffset;
+                        region.bufferRowLength = 0; // Tightly packed
+                        region.bufferImageHeight = 0;
+                        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                        region.imageSubresource.mipLevel = level;
+                        region.imageSubresource.baseArrayLayer = 0;
+                        region.imageSubresource.layerCount = 1;
+                        region.imageOffset = {(pageX + startX) >> level, (pageY + startY) >> level, 0};
+                        region.imageExtent = {static_cast<uint32_t>(levelWidth), static_cast<uint32_t>(levelHeight), 1};
+                        m_atlasRegions.push_back(region);
+                        
+                        stagingOffset += levelWidth * levelHeight;
+                    }
+                    uploadedTiles += tileX - runStart;
                 }
             }
+            
+            job.regionCount = static_cast<uint32_t>(m_atlasRegions.size()) - job.firstRegion;
+            m_atlasEncodeJobs.push_back(job);
         }
     }
     
-    // Debug - log if we found any particles
-    static int frameCount = 0;
-    if (frameCount++ % 60 == 0 || nonEmptyPixels > 0) {
-        std::cout << "World texture update: found " << nonEmptyPixels << " non-empty pixels" << std::endl;
+    // Fill the staged regions, one chunk per task. Every region has its own
+    // slice of staging memory, so the tasks never write to the same bytes.
+    JobSystem::Get().ParallelFor(0, static_cast<int>(m_atlasEncodeJobs.size()), [this](int index) {
+        const AtlasEncodeJob& job = m_atlasEncodeJobs[index];
+        
+        // Each level is built from the one above in local memory; staging
+        // memory may be write-combined and slow to read back
+        uint8_t levels[ATLAS_MIP_LEVELS][ATLAS_PAGE_SIZE * 8]; // Up to a page-wide row of 8-cell tiles
+        
+        for (uint32_t r = job.firstRegion; r < job.firstRegion + job.regionCount; r += ATLAS_MIP_LEVELS) {
+            const VkBufferImageCopy& region = m_atlasRegions[r];
+            const int startX = region.imageOffset.x - job.pageOrigin.x;
+            const int startY = region.imageOffset.y - job.pageOrigin.y;
+            const int width = static_cast<int>(region.imageExtent.width);
+            const int height = static_cast<int>(region.imageExtent.height);
+            
+            uint8_t* out = levels[0];
+            for (int y = startY; y < startY + height; y++) {
+                memcpy(out, job.chunk->GetRow(y) + startX, width);
+                out += width;
+            }
+            
+            for (uint32_t level = 0; level < ATLAS_MIP_LEVELS; level++) {
+                const int levelWidth = width >> level;
+                const int levelHeight = height >> level;
+                if (level > 0) {
+                    DownsampleMaterials(levels[level - 1], levelWidth * 2, levelHeight * 2, levels[level]);
+                }
+                memcpy(m_stagingMapped + m_atlasRegions[r + level].bufferOffset, levels[level], levelWidth * levelHeight);
+            }
+        }
+    });
+    
+    if (!m_atlasRegions.empty()) {
+        uploadStagedRegions(m_worldAtlas.image, VK_FORMAT_R8_UINT, m_atlasRegions);
+    }
+    
+    // Upload only the page table texels that changed: the strip a pan
+    // exposed, plus chunks that came, went or moved to another page. Each
+    // run of changed texels along a row becomes one copy region.
+    const bool fullUpload = m_pageTable.size() != pageTable.size();
+    m_pageTableRegions.clear();
+    VkDeviceSize tableBytes = 0;
+    for (int y = 0; y < PAGE_TABLE_SIZE; y++) {
+        const int rowStart = y * PAGE_TABLE_SIZE;
+        int x = 0;
+        while (x < PAGE_TABLE_SIZE) {
+            if (!fullUpload && pageTable[rowStart + x] == m_pageTable[rowStart + x]) {
+                x++;
+                continue;
+            }
+            
+            const int runStart = x;
+            while (x < PAGE_TABLE_SIZE && (fullUpload || pageTable[rowStart + x] != m_pageTable[rowStart + x])) {
+                x++;
+            }
+            
+            VkBufferImageCopy region{};
+            region.bufferOffset = tableBytes; // Relative to the table's reservation
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {runStart, y, 0};
+            region.imageExtent = {static_cast<uint32_t>(x - runStart), 1, 1};
+            m_pageTableRegions.push_back(region);
+            
+            tableBytes += (x - runStart) * sizeof(uint32_t);
+        }
     }
     
-    // Create staging buffer
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                stagingBuffer, stagingBufferMemory);
-    
-    // Copy pixel data to staging buffer
-    void* data;
-    vkMapMemory(m_device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, pixels.data(), bufferSize);
-    vkUnmapMemory(m_device, stagingBufferMemory);
-    
-    // Prepare texture for transfer
-    transitionImageLayout(m_worldTexture.image, VK_FORMAT_R8G8B8A8_UNORM, 
-                          VK_IMAGE_LAYOUT_UNDEFINED, 
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    // Fits in the reservation made up front, which covers the whole table
+    for (VkBufferImageCopy& region : m_pageTableRegions) {
+        const uint32_t* source = &pageTable[region.imageOffset.y * PAGE_TABLE_SIZE + region.imageOffset.x];
+        region.bufferOffset += tableOffset;
+        memcpy(m_stagingMapped + region.bufferOffset, source, region.imageExtent.width * sizeof(uint32_t));
+    }
+    
+    if (!m_pageTableRegions.empty()) {
+        uploadStagedRegions(m_pageTableTexture.image, VK_FORMAT_R32_UINT, m_pageTableRegions);
+    }
     
-    // Copy from buffer to image
-    copyBufferToImage(stagingBuffer, m_worldTexture.image, width, height);
+    m_pageTable.swap(pageTable);
+    m_pageTableOrigin = minChunk;
     
-    // Transition to shader readable format
-    transitionImageLayout(m_worldTexture.image, VK_FORMAT_R8G8B8A8_UNORM, 
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
-                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    // Fog masks share the page table's window
+    updateFog(minChunk, maxChunk);
     
-    // Cleanup staging buffer
-    vkDestroyBuffer(m_device, stagingBuffer, nullptr);
-    vkFreeMemory(m_device, stagingBufferMemory, nullptr);
+    // Upload volume, reported with the frame timings
+    m_atlasTileUploads.add(uploadedTiles);
+    m_atlasRegionUploads.add(static_cast<double>(m_atlasRegions.size()));
+    m_atlasDeferredChunks.add(deferredChunks);
 }
 
-void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, int cameraX, int cameraY, float zoomLevel) {
-    // Define uniform buffer data
-    struct UniformBufferObject {
-        float cameraX;
-        float cameraY;
-        float zoomLevel;
-        float time;  // For animation effects
-        
-        // Padding to maintain 16-byte alignment
-        float padding[12];
-    };
+uint32_t VulkanRenderer::acquireAtlasPage(const glm::ivec2& chunkCoord) {
+    // Take a free page if there is one, otherwise the least recently used
+    // page that isn't on screen this frame
+    uint32_t best = NO_ATLAS_PAGE;
+    for (uint32_t i = 0; i < m_atlasPages.size(); i++) {
+        const AtlasPage& page = m_atlasPages[i];
+        if (!page.inUse) {
+            best = i;
+            break;
+        }
+        if (page.lastUsedFrame == m_atlasFrame)
+            continue;
+        if (best == NO_ATLAS_PAGE || page.lastUsedFrame < m_atlasPages[best].lastUsedFrame) {
+            best = i;
+        }
+    }
+    
+    if (best == NO_ATLAS_PAGE)
+        return NO_ATLAS_PAGE;
+    
+    AtlasPage& page = m_atlasPages[best];
+    if (page.inUse) {
+        m_chunkPages.erase(page.chunkCoord);
+    }
+    
+    page.chunkCoord = chunkCoord;
+    page.lastUsedFrame = m_atlasFrame;
+    page.uploadedTick = 0;
+    page.inUse = true;
+    m_chunkPages[chunkCoord] = best;
+    return best;
+}
+
+void VulkanRenderer::updateLightMap(const WorldSnapshot& snapshot, int cameraX, int cameraY) {
+    m_lightMap.update(snapshot, cameraX, cameraY);
+    
+    const std::vector<uint8_t>& texels = m_lightMap.getTexels();
+    const int blockSize = LightMap::BLOCK_SIZE;
+    const bool fullUpload = m_lightMapStale || m_lightMap.isFullyChanged();
+    
+    // The whole map after the window moved, otherwise one region per block
+    // that is or just stopped being lit
+    std::vector<VkBufferImageCopy>& regions = m_lightMapRegions;
+    regions.clear();
+    if (fullUpload) {
+        const VkDeviceSize offset = allocateStaging(texels.size());
+        if (offset == VK_WHOLE_SIZE) {
+            m_lightMapStale = true; // Try again next frame
+            return;
+        }
+        memcpy(m_stagingMapped + offset, texels.data(), texels.size());
+        
+        VkBufferImageCopy region{};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {static_cast<uint32_t>(LightMap::SIZE), static_cast<uint32_t>(LightMap::SIZE), 1};
+        regions.push_back(region);
+    } else {
+        const std::vector<int>& blocks = m_lightMap.getChangedBlocks();
+        if (blocks.empty())
+            return;
+        
+        const VkDeviceSize blockBytes = blockSize * blockSize;
+        const VkDeviceSize offset = allocateStaging(blocks.size() * blockBytes);
+        if (offset == VK_WHOLE_SIZE) {
+            m_lightMapStale = true;
+            return;
+        }
+        
+        for (size_t i = 0; i < blocks.size(); i++) {
+            const int blockX = blocks[i] % LightMap::BLOCKS_PER_SIDE;
+            const int blockY = blocks[i] / LightMap::BLOCKS_PER_SIDE;
+            
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset + i * blockBytes;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {blockX * blockSize, blockY * blockSize, 0};
+            region.imageExtent = {static_cast<uint32_t>(blockSize), static_cast<uint32_t>(blockSize), 1};
+            regions.push_back(region);
+            
+            // Pack the block's rows tightly
+            uint8_t* out = m_stagingMapped + region.bufferOffset;
+            for (int row = 0; row < blockSize; row++) {
+                memcpy(out + row * blockSize, &texels[static_cast<size_t>(blockY * blockSize + row) * LightMap::SIZE + blockX * blockSize], blockSize);
+            }
+        }
+    }
+    
+    uploadStagedRegions(m_lightMapTexture.image, VK_FORMAT_R8_UNORM, regions);
+    m_lightMapOrigin = m_lightMap.getOrigin();
+    m_lightMapStale = false;
+}
+
+void VulkanRenderer::updateMinimap(const WorldSnapshot& snapshot, int cameraX, int cameraY) {
+    m_minimap.update(snapshot, cameraX, cameraY);
+    if (!m_minimapVisible) {
+        m_minimapStale = true;
+        return;
+    }
+    
+    const std::vector<uint8_t>& texels = m_minimap.getTexels();
+    const int blockSize = Minimap::TEXELS_PER_CHUNK;
     
+    // The whole window when the texture is behind, otherwise one region per
+    // chunk whose summary changed or that just came into the window
+    std::vector<VkBufferImageCopy>& regions = m_minimapRegions;
+    regions.clear();
+    if (m_minimapStale || m_minimap.isFullyChanged()) {
+        const VkDeviceSize offset = allocateStaging(texels.size());
+        if (offset == VK_WHOLE_SIZE) {
+            m_minimapStale = true; // Try again next frame
+            return;
+        }
+        memcpy(m_stagingMapped + offset, texels.data(), texels.size());
+        
+        VkBufferImageCopy region{};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {static_cast<uint32_t>(Minimap::SIZE), static_cast<uint32_t>(Minimap::SIZE), 1};
+        regions.push_back(region);
+    } else {
+        const std::vector<int>& blocks = m_minimap.getChangedBlocks();
+        if (blocks.empty()) {
+            m_minimapOrigin = m_minimap.getOrigin();
+            return;
+        }
+        
+        const VkDeviceSize blockBytes = blockSize * blockSize;
+        const VkDeviceSize offset = allocateStaging(blocks.size() * blockBytes);
+        if (offset == VK_WHOLE_SIZE) {
+            m_minimapStale = true;
+            return;
+        }
+        
+        for (size_t i = 0; i < blocks.size(); i++) {
+            const int blockX = blocks[i] % Minimap::CHUNKS_PER_SIDE;
+            const int blockY = blocks[i] / Minimap::CHUNKS_PER_SIDE;
+            
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset + i * blockBytes;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {blockX * blockSize, blockY * blockSize, 0};
+            region.imageExtent = {static_cast<uint32_t>(blockSize), static_cast<uint32_t>(blockSize), 1};
+            regions.push_back(region);
+            
+            uint8_t* out = m_stagingMapped + region.bufferOffset;
+            for (int row = 0; row < blockSize; row++) {
+                memcpy(out + row * blockSize, &texels[static_cast<size_t>(blockY * blockSize + row) * Minimap::SIZE + blockX * blockSize], blockSize);
+            }
+        }
+    }
+    
+    uploadStagedRegions(m_minimapTexture.image, VK_FORMAT_R8_UINT, regions);
+    m_minimapOrigin = m_minimap.getOrigin();
+    m_minimapStale = false;
+}
+
+void VulkanRenderer::updateFog(const glm::ivec2& minChunk, const glm::ivec2& maxChunk) {
+    if (!m_visibility)
+        return;
+    
+    const int rows = Chunk::CHUNK_SIZE;
+    if (m_fogMasks.empty()) {
+        m_fogMasks.assign(static_cast<size_t>(PAGE_TABLE_SIZE) * PAGE_TABLE_SIZE * rows, 0);
+        m_fogBlockSent.assign(PAGE_TABLE_SIZE * PAGE_TABLE_SIZE, 0);
+    }
+    
+    // A chunk row's 64 bits go up as two texels, low half first (the host
+    // is little endian like every GPU we target)
+    static const uint64_t HIDDEN[ATLAS_PAGE_SIZE] = {};
+    const VkDeviceSize blockBytes = rows * sizeof(uint64_t);
+    m_fogRegions.clear();
+    bool stagingFull = false;
+    
+    for (int chunkY = minChunk.y; chunkY <= maxChunk.y && !stagingFull; chunkY++) {
+        for (int chunkX = minChunk.x; chunkX <= maxChunk.x && !stagingFull; chunkX++) {
+            const uint64_t* mask = m_visibility->GetChunkMask(glm::ivec2(chunkX, chunkY));
+            if (!mask) {
+                mask = HIDDEN;
+            }
+            
+            const int slotX = chunkX & (PAGE_TABLE_SIZE - 1);
+            const int slotY = chunkY & (PAGE_TABLE_SIZE - 1);
+            const int block = slotY * PAGE_TABLE_SIZE + slotX;
+            uint64_t* held = &m_fogMasks[static_cast<size_t>(block) * rows];
+            if (m_fogBlockSent[block] && std::equal(mask, mask + rows, held))
+                continue;
+            
+            // Out of staging space: the rest goes next frame
+            const VkDeviceSize offset = allocateStaging(blockBytes);
+            if (offset == VK_WHOLE_SIZE) {
+                stagingFull = true;
+                continue;
+            }
+            memcpy(m_stagingMapped + offset, mask, blockBytes);
+            std::copy(mask, mask + rows, held);
+            m_fogBlockSent[block] = 1;
+            
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {slotX * FOG_TEXELS_PER_ROW, slotY * rows, 0};
+            region.imageExtent = {static_cast<uint32_t>(FOG_TEXELS_PER_ROW), static_cast<uint32_t>(rows), 1};
+            m_fogRegions.push_back(region);
+        }
+    }
+    
+    if (!m_fogRegions.empty()) {
+        uploadStagedRegions(m_fogTexture.image, VK_FORMAT_R32_UINT, m_fogRegions);
+    }
+}
+
+void VulkanRenderer::setMinimapVisible(bool visible) {
+    m_minimapVisible = visible;
+}
+
+void VulkanRenderer::updateUniformBuffer(uint32_t currentImage, int cameraX, int cameraY, float zoomLevel) {
     // Update the UBO with current frame information
     UniformBufferObject ubo{};
     
-    // Convert camera position to normalized device coordinates
-    ubo.cameraX = static_cast<float>(cameraX) / m_screenWidth;
-    ubo.cameraY = static_cast<float>(cameraY) / m_screenHeight;
-    ubo.zoomLevel = zoomLevel;
+    // At reduced resolution the same cells cover fewer pixels
+    ubo.resolution = glm::vec2(m_renderExtent.width, m_renderExtent.height);
+    ubo.worldOffset = glm::vec2(cameraX, cameraY);
+    ubo.zoomLevel = zoomLevel * m_renderScale;
+    ubo.pageTableOrigin = m_pageTableOrigin;
+    ubo.lightMapOrigin = m_lightMapOrigin;
+    
+    // Minimap in the top right corner, shrunk along with the render extent
+    const float minimapSize = MINIMAP_SCREEN_SIZE * m_renderScale;
+    const float minimapMargin = MINIMAP_MARGIN * m_renderScale;
+    ubo.minimapRect = glm::vec4(m_renderExtent.width - minimapMargin - minimapSize, minimapMargin, minimapSize, minimapSize);
+    ubo.minimapOrigin = m_minimapOrigin;
+    ubo.fogEnabled = m_visibility ? 1 : 0;
     
     // Update time for animation effects
     static auto startTime = std::chrono::high_resolution_clock::now();
+    static float lastTime = 0.0f;
     auto currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
     ubo.time = time;
+    ubo.deltaTime = time - lastTime;
+    lastTime = time;
     
-    // Map memory and copy data to the uniform buffer
-    void* data;
-    vkMapMemory(m_device, m_uniformBufferMemory, 0, sizeof(UniformBufferObject), 0, &data);
-    memcpy(data, &ubo, sizeof(UniformBufferObject));
-    vkUnmapMemory(m_device, m_uniformBufferMemory);
+    // This frame's buffer is persistently mapped and coherent
+    memcpy(m_uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
 }
 
 // Implementation of memoryType helper
@@ -2144,4 +3636,4 @@ void VulkanRenderer::destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugU
     }
 }
 
-} // namespace Engine
+} // namespace Engine
\ No newline at end of file
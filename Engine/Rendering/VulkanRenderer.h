@@ -4,16 +4,26 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <unordered_map>
+#include <chrono>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+#include "LightMap.h"
+#include "Minimap.h"
+#include "RenderTimings.h"
+#include "DynamicResolution.h"
 
 namespace Engine {
 
 // Forward declarations
-class World;
-class Chunk;
+class WorldSnapshot;
+struct ChunkSnapshot;
+struct CapturedFrame;
+class FrameRecorder;
+class VisibilityMap;
 
 struct VulkanTexture {
     VkImage image;
@@ -22,20 +32,26 @@ struct VulkanTexture {
     VkSampler sampler;
     uint32_t width;
     uint32_t height;
+    uint32_t mipLevels;
 };
 
 class VulkanRenderer {
 public:
     VulkanRenderer(int screenWidth, int screenHeight, const std::string& appName = "Dyg Particle Simulation");
     ~VulkanRenderer();
-
+    
     bool initialize(SDL_Window* window);
     void cleanup();
     
     void beginFrame();
     void endFrame();
     
-    void renderWorld(const World& world, int cameraX = 0, int cameraY = 0, float zoomLevel = 1.0f);
+    // Block until the GPU is done with the next frame's resources. beginFrame
+    // waits as well; calling this first lets the caller do the waiting before
+    // it reads input instead of after.
+    void waitForFrame();
+    
+    void renderWorld(const WorldSnapshot& snapshot, int cameraX = 0, int cameraY = 0, float zoomLevel = 1.0f);
     
     // Setters for rendering properties
     void setClearColor(float r, float g, float b, float a = 1.0f);
@@ -46,7 +62,35 @@ public:
     
     // Window resize handling
     void handleResize(int width, int height);
-
+    
+    // Frame recording: captureFrame, called before endFrame, copies the
+    // frame's image into a readback buffer. The pixels are picked up once the
+    // frame's fence has signaled, a frame or two later, and the frame is then
+    // submitted to the recorder, or released if the image can't be copied.
+    void setFrameRecorder(FrameRecorder* recorder) { m_frameRecorder = recorder; }
+    void captureFrame(CapturedFrame* frame);
+    
+    // Recent GPU and CPU time per phase of the frame
+    RenderTimings getRenderTimings() const;
+    
+    // Dynamic resolution: with it on, the world is drawn below full size
+    // whenever GPU frames run over the budget
+    void setDynamicResolution(bool enabled, float budgetMs);
+    float getRenderScale() const { return m_renderScale; }
+    
+    // Present mode to ask for; FIFO when the surface doesn't offer it. Takes
+    // effect when the swap chain is next created.
+    void setPresentMode(VkPresentModeKHR mode);
+    VkPresentModeKHR getPresentMode() const { return m_presentMode; }
+    
+    // Minimap in the top right corner, drawn as a second quad after the world
+    void setMinimapVisible(bool visible);
+    bool isMinimapVisible() const { return m_minimapVisible; }
+    
+    // Darken cells the map doesn't show as visible; null turns fog off. The
+    // map is read while renderWorld runs.
+    void setVisibility(const VisibilityMap* visibility) { m_visibility = visibility; }
+    
 private:
     // Basic Vulkan objects
     VkInstance m_instance;
@@ -64,6 +108,8 @@ private:
     VkFormat m_swapchainImageFormat;
     VkExtent2D m_swapchainExtent;
     std::vector<VkFramebuffer> m_swapchainFramebuffers;
+    VkPresentModeKHR m_requestedPresentMode;
+    VkPresentModeKHR m_presentMode;   // Mode of the current swap chain
     
     // Command processing
     VkCommandPool m_commandPool;
@@ -83,10 +129,14 @@ private:
     VkPipelineLayout m_pipelineLayout;
     VkPipeline m_graphicsPipeline;
     
+    // Compiled pipeline state, kept on disk between runs so startup can skip
+    // shader compilation; only reused on the same device and driver
+    VkPipelineCache m_pipelineCache;
+    
     // Descriptor sets
     VkDescriptorSetLayout m_descriptorSetLayout;
     VkDescriptorPool m_descriptorPool;
-    VkDescriptorSet m_descriptorSet;
+    std::vector<VkDescriptorSet> m_descriptorSets;  // One per frame in flight
     
     // Vertex/index buffers for quad rendering
     VkBuffer m_vertexBuffer;
@@ -94,12 +144,157 @@ private:
     VkBuffer m_indexBuffer;
     VkDeviceMemory m_indexBufferMemory;
     
-    // Uniform buffer for shader parameters
-    VkBuffer m_uniformBuffer;
-    VkDeviceMemory m_uniformBufferMemory;
+    // Uniform buffers for shader parameters, one per frame in flight and
+    // mapped for their whole lifetime
+    std::vector<VkBuffer> m_uniformBuffers;
+    std::vector<VkDeviceMemory> m_uniformBuffersMemory;
+    std::vector<void*> m_uniformBuffersMapped;
+    
+    // Material palette: color and effect parameters for every material ID,
+    // built once from the MaterialDatabase and shared by all frames
+    static constexpr uint32_t PALETTE_SIZE = 256;
+    VkBuffer m_paletteBuffer;
+    VkDeviceMemory m_paletteBufferMemory;
+    
+    // Staging ring for texture uploads: one STAGING_FRAME_SIZE slice per
+    // frame in flight, persistently mapped. A slice is only reused after the
+    // frame's fence has signaled.
+    static constexpr VkDeviceSize STAGING_FRAME_SIZE = 4 * 1024 * 1024;
+    VkBuffer m_stagingBuffer;
+    VkDeviceMemory m_stagingBufferMemory;
+    uint8_t* m_stagingMapped;
+    VkDeviceSize m_stagingHead;  // Bytes used in the current frame's slice
+    
+    // Per-frame scratch, kept to avoid reallocating
+    std::vector<VkBufferImageCopy> m_atlasRegions;
+    std::vector<uint32_t> m_pageTableScratch;
+    std::vector<VkBufferImageCopy> m_pageTableRegions;
+    std::vector<VkBufferImageCopy> m_lightMapRegions;
+    std::vector<VkBufferImageCopy> m_minimapRegions;
+    std::vector<VkBufferImageCopy> m_fogRegions;
+    
+    // Staged atlas regions of one chunk, filled on the job system
+    struct AtlasEncodeJob {
+        const ChunkSnapshot* chunk;
+        glm::ivec2 pageOrigin;   // Atlas texel of the page's corner
+        uint32_t firstRegion;    // Index into m_atlasRegions
+        uint32_t regionCount;
+    };
+    std::vector<AtlasEncodeJob> m_atlasEncodeJobs;
+    
+    // World atlas: one page of material IDs (R8_UINT) per visible chunk,
+    // laid out in a square grid. Pages are refreshed tile by tile, for the
+    // tiles that changed since the page was last filled, and handed out
+    // least recently used first.
+    static constexpr uint32_t ATLAS_PAGE_SIZE = 64;       // Chunk::CHUNK_SIZE
+    static constexpr uint32_t ATLAS_PAGES_PER_ROW = 32;
+    static constexpr uint32_t ATLAS_PAGE_COUNT = ATLAS_PAGES_PER_ROW * ATLAS_PAGES_PER_ROW;
+    static constexpr uint32_t NO_ATLAS_PAGE = UINT32_MAX;
+    
+    // Mip levels of the atlas: full detail, then 2x, 4x and 8x downsampled.
+    // Each texel of a level holds the most common material of the 2x2 texels
+    // below it, and the shader picks the level from the zoom.
+    static constexpr uint32_t ATLAS_MIP_LEVELS = 4;
+    
+    struct AtlasPage {
+        glm::ivec2 chunkCoord;
+        uint64_t lastUsedFrame;
+        uint64_t uploadedTick;   // Snapshot tick the page's contents are from
+        bool inUse;
+    };
     
-    // World texture for rendering particles
-    VulkanTexture m_worldTexture;
+    VulkanTexture m_worldAtlas;
+    std::vector<AtlasPage> m_atlasPages;
+    std::unordered_map<glm::ivec2, uint32_t> m_chunkPages;
+    uint64_t m_atlasFrame;
+    
+    // Page table: a window of PAGE_TABLE_SIZE x PAGE_TABLE_SIZE chunks starting
+    // at m_pageTableOrigin, holding each chunk's page + 1 (0 = nothing to draw).
+    // The window wraps around: chunk c lives in texel c mod PAGE_TABLE_SIZE,
+    // so a pan only rewrites the row or column of chunks it exposes.
+    static constexpr int PAGE_TABLE_SIZE = 64;
+    VulkanTexture m_pageTableTexture;
+    std::vector<uint32_t> m_pageTable;   // Texture contents; empty until first upload
+    glm::ivec2 m_pageTableOrigin;
+    
+    // Frame recording: one host-visible readback buffer per frame in flight,
+    // grown to the swap chain size on first use and kept mapped
+    struct CaptureReadback {
+        VkBuffer buffer;
+        VkDeviceMemory memory;
+        uint8_t* mapped;
+        VkDeviceSize size;
+        CapturedFrame* frame;    // Copy in flight, waiting on the frame's fence
+    };
+    std::vector<CaptureReadback> m_captureReadbacks;
+    FrameRecorder* m_frameRecorder;
+    CapturedFrame* m_pendingCapture;    // Captured by this frame's endFrame
+    bool m_swapchainCapturable;         // Images allow transfers and hold 8-bit RGBA or BGRA
+    
+    // GPU timestamps at the phase boundaries of each frame in flight. They
+    // are read back once the frame's fence has signaled, so reading them
+    // never waits on the GPU.
+    enum FrameTimestamp : uint32_t {
+        TIMESTAMP_FRAME_START,
+        TIMESTAMP_UPLOADS_DONE,
+        TIMESTAMP_PASS_DONE,
+        TIMESTAMP_FRAME_END,
+        TIMESTAMPS_PER_FRAME
+    };
+    VkQueryPool m_timestampPool;             // Null when the queue has no timestamps
+    double m_timestampPeriod;                // Nanoseconds per tick
+    uint64_t m_timestampMask;                // Valid bits of a timestamp
+    std::vector<uint8_t> m_timestampsWritten;  // Per frame in flight
+    std::chrono::high_resolution_clock::time_point m_recordStart;
+    RollingAverage m_gpuUploadTime, m_gpuDrawTime, m_gpuPostPassTime, m_gpuFrameTime;
+    RollingAverage m_cpuAcquireTime, m_cpuRecordTime, m_cpuPresentTime;
+    RollingAverage m_atlasTileUploads, m_atlasRegionUploads, m_atlasDeferredChunks;
+    
+    // Dynamic resolution: below full scale the world is drawn into an
+    // offscreen target covering part of the swap chain size, then blitted
+    // onto the swap chain image with linear filtering. Targets are full size,
+    // one per frame in flight, so the scale can change every frame.
+    struct ScaledTarget {
+        VkImage image;
+        VkDeviceMemory memory;
+        VkImageView view;
+        VkFramebuffer framebuffer;
+    };
+    std::vector<ScaledTarget> m_scaledTargets;   // Empty when the swap chain can't be blitted to
+    VkRenderPass m_scaledRenderPass;             // As m_renderPass, but ends ready for the blit
+    bool m_swapchainScalable;                    // Swap chain images take linear blits
+    DynamicResolution m_dynamicResolution;
+    bool m_dynamicResolutionEnabled;
+    float m_renderScale;                         // Scale of the frame being recorded
+    VkExtent2D m_renderExtent;                   // Size the world is drawn at in this frame
+    
+    // Light from emissive materials, computed on the CPU and sampled with
+    // linear filtering (R8_UNORM); see LightMap
+    LightMap m_lightMap;
+    VulkanTexture m_lightMapTexture;
+    glm::ivec2 m_lightMapOrigin;     // Chunk at texel (0, 0) of the uploaded map
+    bool m_lightMapStale;            // An upload was dropped; send the whole map
+    
+    // Minimap: material IDs (R8_UINT), one texel per render tile, for a wide
+    // window around the camera; see Minimap. The summaries are kept up to
+    // date while it's hidden, and the texture is sent whole once it shows.
+    static constexpr float MINIMAP_SCREEN_SIZE = 256.0f;   // Side in pixels at full resolution
+    static constexpr float MINIMAP_MARGIN = 16.0f;
+    Minimap m_minimap;
+    VulkanTexture m_minimapTexture;
+    glm::ivec2 m_minimapOrigin;      // First chunk of the uploaded window
+    bool m_minimapStale;             // Texture behind the minimap; send it whole
+    bool m_minimapVisible;
+    
+    // Fog of war: visible cells of each chunk in the page table window, one
+    // bit per cell (R32_UINT), two texels per chunk row. Chunk c's 2 x 64
+    // block is at block c mod PAGE_TABLE_SIZE, wrapping like the page table.
+    // Only blocks whose bits differ from what the texture holds are sent.
+    static constexpr int FOG_TEXELS_PER_ROW = 2;
+    const VisibilityMap* m_visibility;
+    VulkanTexture m_fogTexture;
+    std::vector<uint64_t> m_fogMasks;      // Texture contents, 64 rows per block
+    std::vector<uint8_t> m_fogBlockSent;   // Blocks the texture holds m_fogMasks for
     
     // Screen dimensions
     int m_screenWidth;
@@ -118,6 +313,8 @@ private:
     // Current frame state
     uint32_t m_currentImageIndex;
     bool m_framebufferResized;
+    bool m_frameActive;       // Command buffer is recording this frame
+    bool m_renderPassActive;  // Render pass has begun in this frame
     
     // Max frames in flight
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
@@ -139,7 +336,7 @@ private:
     // Set to false by default as validation layers might not be available
     const bool m_enableValidationLayers = false;
 #endif
-    
+
     // Initialization methods
     bool createInstance();
     bool setupDebugMessenger();
@@ -150,20 +347,34 @@ private:
     bool createImageViews();
     bool createRenderPass();
     bool createDescriptorSetLayout();
+    bool createPipelineCache();
+    void savePipelineCache();
     bool createGraphicsPipeline();
     bool createFramebuffers();
+    bool createScaledTargets();
     bool createCommandPool();
-    bool createWorldTexture(uint32_t width, uint32_t height);
+    bool createWorldAtlas();
+    bool createPageTable();
+    bool createLightMap();
+    bool createMinimap();
+    bool createFogTexture();
+    bool createSampledTexture(VulkanTexture& texture, uint32_t width, uint32_t height, VkFormat format,
+                              uint32_t mipLevels = 1, VkFilter filter = VK_FILTER_NEAREST);
     bool createVertexBuffer();
     bool createIndexBuffer();
-    bool createUniformBuffer();
+    bool createUniformBuffers();
+    bool createPaletteBuffer();
+    bool createStagingBuffer();
     bool createDescriptorPool();
     bool createDescriptorSets();
     bool createCommandBuffers();
     bool createSyncObjects();
+    bool createTimestampQueries();
     
     // Helper methods for init/shutdown
     void cleanupSwapChain();
+    void destroyScaledTargets();
+    void destroyTexture(VulkanTexture& texture);
     void recreateSwapChain();
     
     // Vulkan utility methods
@@ -205,20 +416,56 @@ private:
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+    void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
+    void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+    void copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions);
+    void uploadStagedRegions(VkImage image, VkFormat format, const std::vector<VkBufferImageCopy>& regions);
+    
+    // Reserve bytes in this frame's staging slice; returns the offset into
+    // m_stagingBuffer, or VK_WHOLE_SIZE if the slice is full
+    VkDeviceSize allocateStaging(VkDeviceSize size);
+    
+    // Starts the frame's render pass, after any uploads have been recorded
+    void beginRenderPass();
+    
+    // Scale the offscreen target up onto the swap chain image
+    void blitScaledTarget();
     
     // Command buffer helpers
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
     
+    // Frame recording helpers: record the copy of the frame's image, and hand
+    // a finished copy to the recorder
+    void recordCapture(CapturedFrame* frame);
+    void finishCapture(CaptureReadback& readback);
+    bool ensureCaptureReadback(CaptureReadback& readback, VkDeviceSize size);
+    void destroyCaptureReadback(CaptureReadback& readback);
+    
+    // Write one of this frame's timestamps, and average a finished frame's
+    void writeTimestamp(FrameTimestamp timestamp, VkPipelineStageFlagBits stage);
+    void readTimestamps(size_t frame);
+    
     // Update uniform buffer with current frame info
     void updateUniformBuffer(uint32_t currentImage, int cameraX, int cameraY, float zoomLevel);
     
     // Update world texture from simulation data
-    void updateWorldTexture(const World& world, int cameraX = 0, int cameraY = 0, float zoomLevel = 1.0f);
+    void updateWorldTexture(const WorldSnapshot& snapshot, int cameraX = 0, int cameraY = 0, float zoomLevel = 1.0f);
+    
+    // Recompute the light map around the camera and record its upload
+    void updateLightMap(const WorldSnapshot& snapshot, int cameraX, int cameraY);
+    
+    // Take the snapshot's changes into the minimap and record their upload
+    void updateMinimap(const WorldSnapshot& snapshot, int cameraX, int cameraY);
+    
+    // Record the upload of the visibility masks that changed for the chunks
+    // in view
+    void updateFog(const glm::ivec2& minChunk, const glm::ivec2& maxChunk);
+    
+    // Page for a chunk that doesn't have one yet, or NO_ATLAS_PAGE if every
+    // page is already on screen this frame
+    uint32_t acquireAtlasPage(const glm::ivec2& chunkCoord);
     
     // Debug callback function for validation layers
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
@@ -6,9 +6,14 @@
 
 namespace Engine {
 
-static std::random_device rd;
-static std::mt19937 gen(rd());
-static std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+// Per-thread generator so chunks can be simulated on worker threads
+static thread_local std::mt19937 gen;
+static thread_local std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+void CellularAutomata::SeedRandom(uint32_t seed) {
+    gen.seed(seed);
+    dist.reset();
+}
 
 void CellularAutomata::UpdateParticle(Chunk& chunk, int x, int y, float dt) {
     Particle& particle = chunk.GetParticle(x, y);
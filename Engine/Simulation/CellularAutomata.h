@@ -9,6 +9,10 @@ class CellularAutomata {
 public:
     static void UpdateParticle(Chunk& chunk, int x, int y, float dt);
     
+    // Restart the calling thread's random numbers from a seed. Every chunk
+    // update seeds it first, so results don't depend on the thread it ran on.
+    static void SeedRandom(uint32_t seed);
+    
     static bool IsEmpty(const Chunk& chunk, int x, int y);
     static bool IsInBounds(const Chunk& chunk, int x, int y);
     static bool MoveParticle(Chunk& chunk, int srcX, int srcY, int destX, int destY);
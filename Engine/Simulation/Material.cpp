@@ -41,6 +41,7 @@ void MaterialDatabase::Initialize() {
     Material fire(4, "Fire");
     fire.density = 0.2f;
     fire.flammability = 1.0f;
+    fire.emissive = 0.7f;
     fire.color = glm::vec4(1.0f, 0.3f, 0.0f, 0.9f); // Orange-red
     db.AddMaterial(fire);
     
@@ -139,6 +140,9 @@ void MaterialDatabase::LoadMaterials(const std::string& configPath) {
             if (materialJson.contains("corrosiveness"))
                 material.corrosiveness = materialJson["corrosiveness"].get<float>();
                 
+            if (materialJson.contains("emissive"))
+                material.emissive = materialJson["emissive"].get<float>();
+                
             // Load color
             if (materialJson.contains("color")) {
                 auto& colorJson = materialJson["color"];
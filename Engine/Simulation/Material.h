@@ -23,6 +23,7 @@ struct Material {
     // Additional parameters
     float spreadFactor = 1.0f;  // How quickly it spreads horizontally
     float corrosiveness = 0.0f; // How quickly it corrodes other materials
+    float emissive = 0.0f;      // Glow strength when rendered
     
     // Default constructor required for std::unordered_map
     Material() 
@@ -47,6 +48,10 @@ public:
         return m_Materials.at(id);
     }
     
+    bool HasMaterial(uint8_t id) const {
+        return m_Materials.find(id) != m_Materials.end();
+    }
+    
     static void Initialize();
     static void LoadMaterials(const std::string& configPath);
     
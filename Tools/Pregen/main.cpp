@@ -0,0 +1,345 @@
+#include "Engine/Core/JobSystem.h"
+#include "Engine/Core/Timer.h"
+#include "Engine/Procedural/Chunk.h"
+#include "Engine/Procedural/World.h"
+#include "Engine/Procedural/Prefab.h"
+#include "Engine/Procedural/WorldSnapshot.h"
+#include "Engine/Procedural/ProceduralGenerator.h"
+#include "Engine/Rendering/SoftwareRenderer.h"
+#include "Engine/Simulation/Material.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Offline world pre-generation: fills a rectangle of chunks with the
+// procedural generator and writes them in the game's save format, along
+// with the seed so the game generates the surrounding chunks to match.
+//
+// Usage: DygPregen <minX> <minY> <maxX> <maxY> [--seed N] [--out DIR] [--threads N] [--thumbnail FILE]
+//                  [--verify-parallel TICKS] [--verify-prefabs]
+
+// Largest thumbnail side in pixels; bigger rectangles are zoomed out
+static const int MAX_THUMBNAIL_SIZE = 2048;
+
+static void PrintUsage() {
+    std::cout << "Usage: DygPregen <minX> <minY> <maxX> <maxY> [--seed N] [--out DIR] [--threads N] [--thumbnail FILE]" << std::endl;
+    std::cout << "                 [--verify-parallel TICKS] [--verify-prefabs]" << std::endl;
+    std::cout << "  Chunk coordinates are inclusive. Defaults: --seed 12345 --out worlddata" << std::endl;
+    std::cout << "  --thumbnail renders the generated rectangle to a PPM image" << std::endl;
+    std::cout << "  --verify-parallel simulates the result for TICKS ticks with serial and with" << std::endl;
+    std::cout << "    parallel chunk updates (--threads of them) and fails unless both agree" << std::endl;
+    std::cout << "  --verify-prefabs round-trips a prefab through both file formats and stamps" << std::endl;
+    std::cout << "    every transform of it, failing on any cell that differs" << std::endl;
+}
+
+// FNV-1a over the hashes in order
+static uint64_t CombineHashes(const std::vector<uint64_t>& hashes) {
+    uint64_t combined = 14695981039346656037ULL;
+    for (uint64_t hash : hashes) {
+        for (int byte = 0; byte < 8; byte++) {
+            combined ^= (hash >> (byte * 8)) & 0xFF;
+            combined *= 1099511628211ULL;
+        }
+    }
+    return combined;
+}
+
+// Loads the saved rectangle, simulates it and returns the hash of every
+// chunk left, in row-major order; elapsedMs gets the simulation time
+static uint64_t SimulateSavedWorld(const std::string& outputDir, const glm::ivec2& minCoord, const glm::ivec2& maxCoord,
+                                   int ticks, unsigned int threadCount, float& elapsedMs, size_t& chunkCount) {
+    // The whole rectangle takes part, so nothing is streamed in or out
+    Engine::World world;
+    world.SetUpdateThreadCount(threadCount);
+    world.SetStreamingEnabled(false);
+    for (int y = minCoord.y; y <= maxCoord.y; y++) {
+        for (int x = minCoord.x; x <= maxCoord.x; x++) {
+            world.LoadChunk(outputDir, glm::ivec2(x, y));
+        }
+    }
+    
+    Engine::Timer timer;
+    for (int tick = 0; tick < ticks; tick++) {
+        world.Update(1.0f / 60.0f);
+    }
+    elapsedMs = timer.GetElapsedTimeMs();
+    
+    std::vector<std::pair<glm::ivec2, uint64_t>> chunkHashes;
+    world.ForEachChunk([&](const Engine::Chunk& chunk) {
+        chunkHashes.emplace_back(chunk.GetCoord(), chunk.ComputeHash());
+    });
+    std::sort(chunkHashes.begin(), chunkHashes.end(), [](const auto& a, const auto& b) {
+        return a.first.y != b.first.y ? a.first.y < b.first.y : a.first.x < b.first.x;
+    });
+    
+    std::vector<uint64_t> hashes;
+    for (const auto& [coord, hash] : chunkHashes) {
+        hashes.push_back(hash);
+    }
+    chunkCount = hashes.size();
+    return CombineHashes(hashes);
+}
+
+// Simulation is deterministic per chunk, so any thread count has to end up
+// with the same world as serial updates
+static bool VerifyParallelUpdates(const std::string& outputDir, const glm::ivec2& minCoord, const glm::ivec2& maxCoord,
+                                  int ticks, unsigned int threadCount) {
+    Engine::MaterialDatabase::Initialize();
+    
+    float serialMs = 0.0f;
+    float parallelMs = 0.0f;
+    size_t serialChunks = 0;
+    size_t parallelChunks = 0;
+    const uint64_t serialHash = SimulateSavedWorld(outputDir, minCoord, maxCoord, ticks, 1, serialMs, serialChunks);
+    const uint64_t parallelHash = SimulateSavedWorld(outputDir, minCoord, maxCoord, ticks, threadCount, parallelMs, parallelChunks);
+    
+    char hashText[40];
+    std::snprintf(hashText, sizeof(hashText), "%016llx / %016llx",
+                  static_cast<unsigned long long>(serialHash), static_cast<unsigned long long>(parallelHash));
+    std::cout << "Simulated " << serialChunks << " chunks for " << ticks << " ticks: serial " << serialMs
+              << " ms, " << threadCount << " threads " << parallelMs << " ms, hashes " << hashText << std::endl;
+    
+    const size_t rectangleChunks = static_cast<size_t>(maxCoord.x - minCoord.x + 1) * (maxCoord.y - minCoord.y + 1);
+    if (serialChunks != rectangleChunks || parallelChunks != rectangleChunks) {
+        std::cerr << "Simulated " << serialChunks << " / " << parallelChunks << " chunks instead of the "
+                  << rectangleChunks << " generated" << std::endl;
+        return false;
+    }
+    
+    if (serialHash != parallelHash) {
+        std::cerr << "Parallel chunk updates differ from serial ones" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool SamePrefab(const Engine::Prefab& a, const Engine::Prefab& b) {
+    if (a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight())
+        return false;
+    
+    for (int y = 0; y < a.GetHeight(); y++) {
+        for (int x = 0; x < a.GetWidth(); x++) {
+            if (a.IsMasked(x, y) != b.IsMasked(x, y) || a.GetMaterial(x, y) != b.GetMaterial(x, y))
+                return false;
+        }
+        
+        int countA = 0;
+        int countB = 0;
+        const Engine::Prefab::Span* spansA = a.GetRowSpans(y, countA);
+        const Engine::Prefab::Span* spansB = b.GetRowSpans(y, countB);
+        if (countA != countB)
+            return false;
+        for (int i = 0; i < countA; i++) {
+            if (spansA[i].start != spansB[i].start || spansA[i].length != spansB[i].length)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Cuts a prefab out of generated terrain, saves it with and without run
+// length encoding and loads both back, then stamps every transform of it
+// across chunk borders and compares the world cell by cell
+static bool VerifyPrefabs(const std::string& outputDir, uint32_t seed) {
+    Engine::ProceduralGenerator generator(seed);
+    Engine::Chunk source(glm::ivec2(0, 0));
+    generator.GenerateChunk(&source);
+    
+    // Non-square so rotations change its shape; some masked cells are air
+    Engine::Prefab prefab(48, 40);
+    for (int y = 0; y < prefab.GetHeight(); y++) {
+        for (int x = 0; x < prefab.GetWidth(); x++) {
+            const uint8_t materialID = source.GetParticle(x + 8, y + 12).materialID;
+            if (materialID != 0 || (x * 7 + y * 3) % 11 == 0) {
+                prefab.SetCell(x, y, materialID);
+            }
+        }
+    }
+    
+    const std::string rleFile = outputDir + "/verify_rle.prefab";
+    const std::string rawFile = outputDir + "/verify_raw.prefab";
+    Engine::Prefab rle;
+    Engine::Prefab raw;
+    bool loaded = prefab.Save(rleFile, true) && prefab.Save(rawFile, false) && rle.Load(rleFile) && raw.Load(rawFile);
+    const auto rleBytes = loaded ? std::filesystem::file_size(rleFile) : 0;
+    const auto rawBytes = loaded ? std::filesystem::file_size(rawFile) : 0;
+    std::filesystem::remove(rleFile);
+    std::filesystem::remove(rawFile);
+    
+    if (!loaded || !SamePrefab(prefab, rle) || !SamePrefab(prefab, raw)) {
+        std::cerr << "Prefab save/load round trip changed the prefab" << std::endl;
+        return false;
+    }
+    
+    const Engine::PrefabTransform transforms[] = {
+        Engine::PrefabTransform::None, Engine::PrefabTransform::FlipX, Engine::PrefabTransform::FlipY,
+        Engine::PrefabTransform::Rotate90, Engine::PrefabTransform::Rotate180, Engine::PrefabTransform::Rotate270
+    };
+    const glm::ivec2 position(-20, -17);
+    for (Engine::PrefabTransform transform : transforms) {
+        Engine::World world;
+        world.Stamp(rle, position, transform);
+        
+        // The world starts out empty, so cells outside the mask stay empty
+        const Engine::World& stamped = world;
+        const Engine::Prefab expected = prefab.Transformed(transform);
+        for (int y = 0; y < expected.GetHeight(); y++) {
+            for (int x = 0; x < expected.GetWidth(); x++) {
+                const uint8_t want = expected.IsMasked(x, y) ? expected.GetMaterial(x, y) : 0;
+                if (stamped.GetParticle(position.x + x, position.y + y).materialID != want) {
+                    std::cerr << "Stamp with transform " << static_cast<int>(transform)
+                              << " differs at (" << x << ", " << y << ")" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    
+    std::cout << "Verified prefab round trip (" << rleBytes << " bytes run-length encoded, " << rawBytes
+              << " bytes raw) and " << std::size(transforms) << " stamp transforms" << std::endl;
+    return true;
+}
+
+// Renders the saved chunks of the rectangle with the software renderer
+static bool WriteThumbnail(const std::string& filename, const std::string& outputDir,
+                           const glm::ivec2& minCoord, const glm::ivec2& maxCoord) {
+    Engine::MaterialDatabase::Initialize();
+    
+    Engine::World world;
+    for (int y = minCoord.y; y <= maxCoord.y; y++) {
+        for (int x = minCoord.x; x <= maxCoord.x; x++) {
+            world.LoadChunk(outputDir, glm::ivec2(x, y));
+        }
+    }
+    
+    const int chunkSize = Engine::Chunk::CHUNK_SIZE;
+    const int cellsX = (maxCoord.x - minCoord.x + 1) * chunkSize;
+    const int cellsY = (maxCoord.y - minCoord.y + 1) * chunkSize;
+    const float zoom = std::min(1.0f, static_cast<float>(MAX_THUMBNAIL_SIZE) / std::max(cellsX, cellsY));
+    const int width = std::max(1, static_cast<int>(cellsX * zoom));
+    const int height = std::max(1, static_cast<int>(cellsY * zoom));
+    
+    Engine::SoftwareRenderer renderer(width, height);
+    if (!renderer.initialize())
+        return false;
+    
+    Engine::WorldSnapshotPublisher publisher;
+    publisher.Publish(world);
+    publisher.AcquireLatest();
+    
+    Engine::Timer timer;
+    renderer.beginFrame();
+    renderer.renderWorld(publisher.GetLatest(), minCoord.x * chunkSize + cellsX / 2, minCoord.y * chunkSize + cellsY / 2, zoom);
+    renderer.endFrame();
+    float elapsedMs = timer.GetElapsedTimeMs();
+    
+    std::cout << "Rendered " << width << "x" << height << " thumbnail in " << elapsedMs << " ms" << std::endl;
+    return renderer.writePPM(filename);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        PrintUsage();
+        return 1;
+    }
+    
+    glm::ivec2 minCoord(std::atoi(argv[1]), std::atoi(argv[2]));
+    glm::ivec2 maxCoord(std::atoi(argv[3]), std::atoi(argv[4]));
+    uint32_t seed = 12345;
+    std::string outputDir = "worlddata";
+    unsigned int threadCount = Engine::JobSystem::DefaultWorkerCount() + 1;
+    std::string thumbnailFile;
+    int verifyTicks = 0;
+    bool verifyPrefabs = false;
+    
+    for (int i = 5; i < argc; i++) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--thumbnail") == 0 && i + 1 < argc) {
+            thumbnailFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--verify-parallel") == 0 && i + 1 < argc) {
+            verifyTicks = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--verify-prefabs") == 0) {
+            verifyPrefabs = true;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    
+    if (maxCoord.x < minCoord.x || maxCoord.y < minCoord.y) {
+        std::cerr << "Empty chunk rectangle" << std::endl;
+        return 1;
+    }
+    
+    std::filesystem::create_directories(outputDir);
+    
+    // Row-major chunk list; hashes are combined in this order so the result
+    // doesn't depend on which thread finished first
+    std::vector<glm::ivec2> coords;
+    for (int y = minCoord.y; y <= maxCoord.y; y++) {
+        for (int x = minCoord.x; x <= maxCoord.x; x++) {
+            coords.emplace_back(x, y);
+        }
+    }
+    std::vector<uint64_t> chunkHashes(coords.size());
+    
+    std::cout << "Generating " << coords.size() << " chunks with seed " << seed
+              << " on " << threadCount << " threads into " << outputDir << std::endl;
+    
+    // The calling thread works too, so the job system gets one worker fewer
+    Engine::JobSystem jobs(threadCount - 1);
+    Engine::Timer timer;
+    
+    jobs.ParallelFor(0, static_cast<int>(coords.size()), [&](int index) {
+        // Generators keep RNG state, so each chunk gets its own
+        Engine::ProceduralGenerator generator(seed);
+        Engine::Chunk chunk(coords[index]);
+        generator.GenerateChunk(&chunk);
+        
+        chunk.Save(Engine::World::ChunkFilename(outputDir, coords[index]));
+        chunkHashes[index] = chunk.ComputeHash();
+    });
+    
+    float elapsed = timer.GetElapsedTime();
+    
+    // The game generates whatever lies outside the rectangle with this seed
+    if (!Engine::World::SaveSeed(outputDir, seed)) {
+        return 1;
+    }
+    
+    const uint64_t worldHash = CombineHashes(chunkHashes);
+    
+    char hashText[17];
+    std::snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(worldHash));
+    
+    std::cout << "Generated " << coords.size() << " chunks in " << elapsed << " s ("
+              << (elapsed > 0.0f ? coords.size() / elapsed : 0.0f) << " chunks/s)" << std::endl;
+    std::cout << "Output hash: " << hashText << std::endl;
+    
+    if (!thumbnailFile.empty() && !WriteThumbnail(thumbnailFile, outputDir, minCoord, maxCoord)) {
+        std::cerr << "Failed to write thumbnail " << thumbnailFile << std::endl;
+        return 1;
+    }
+    
+    if (verifyTicks > 0 && !VerifyParallelUpdates(outputDir, minCoord, maxCoord, verifyTicks, threadCount)) {
+        return 1;
+    }
+    
+    if (verifyPrefabs && !VerifyPrefabs(outputDir, seed)) {
+        return 1;
+    }
+    
+    return 0;
+}
\ No newline at end of file
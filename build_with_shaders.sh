@@ -29,37 +29,9 @@ if [ $CLEAN_BUILD -eq 1 ]; then
   rm -rf build
 fi
 
-# Make output directories
-mkdir -p Engine/Assets/Shaders/spirv
-
-# Check if glslc is available
-if command -v glslc &> /dev/null; then
-  echo -e "${GREEN}Found glslc, compiling shaders...${NC}"
-  
-  # Compile shaders
-  echo -e "${BLUE}Compiling shaders...${NC}"
-  
-  # Vertex shaders
-  for shader in Engine/Assets/Shaders/*.vert; do
-    if [ -f "$shader" ]; then
-      base=$(basename "$shader" .vert)
-      echo -e "${BLUE}Compiling ${shader}...${NC}"
-      glslc -o "Engine/Assets/Shaders/spirv/${base}.vert.spv" "$shader"
-    fi
-  done
-  
-  # Fragment shaders
-  for shader in Engine/Assets/Shaders/*.frag; do
-    if [ -f "$shader" ]; then
-      base=$(basename "$shader" .frag)
-      echo -e "${BLUE}Compiling ${shader}...${NC}"
-      glslc -o "Engine/Assets/Shaders/spirv/${base}.frag.spv" "$shader"
-    fi
-  done
-  
-  echo -e "${GREEN}Shader compilation complete!${NC}"
-else
-  echo -e "${YELLOW}Warning: Could not find glslc shader compiler. Skipping shader compilation.${NC}"
+# CMake compiles the shaders itself and needs glslc for the Vulkan backend
+if ! command -v glslc &> /dev/null && [ -z "$VULKAN_SDK" ]; then
+  echo -e "${YELLOW}Warning: Could not find glslc shader compiler; CMake will stop without it.${NC}"
   echo -e "${YELLOW}Install the Vulkan SDK to compile shaders.${NC}"
 fi
 
@@ -69,13 +41,6 @@ echo -e "${BLUE}Building Dyg-Endless Engine...${NC}"
 # Create build directory if it doesn't exist
 mkdir -p build
 
-# Create shader directories in build
-mkdir -p build/Engine/Assets/Shaders/spirv
-
-# Copy shaders to build directory
-echo -e "${BLUE}Copying shaders to build directory...${NC}"
-cp -f Engine/Assets/Shaders/spirv/*.spv build/Engine/Assets/Shaders/spirv/ 2>/dev/null || echo -e "${YELLOW}No shader files to copy${NC}"
-
 # Configure and build
 echo -e "${BLUE}Configuring with CMake...${NC}"
 cd build
@@ -1,6 +1,9 @@
 #include "Engine/Core/Application.h"
+#include "Engine/Core/FramePacer.h"
 #include "Engine/Simulation/Material.h"
 #include "Engine/Procedural/World.h"
+#include "Engine/Procedural/WorldSnapshot.h"
+#include "Engine/Procedural/VisibilityMap.h"
 #include "Engine/Procedural/ProceduralGenerator.h"
 #include "Engine/Rendering/Renderer.h"
 #include <iostream>
@@ -9,7 +12,13 @@
 #include <memory>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 
 // Global quit flag
 volatile sig_atomic_t g_quit = 0;
@@ -29,6 +38,9 @@ const int WINDOW_WIDTH = 1280;
 const int WINDOW_HEIGHT = 720;
 const char* WINDOW_TITLE = "Dyg-Endless Sand Simulation";
 
+// Max simulation ticks run on newly generated chunks before they are shown
+const int SETTLE_TICKS = 120;
+
 const int TARGET_FPS = 60;
 const double FRAME_TIME = 1000.0 / TARGET_FPS; // ms per frame
 
@@ -37,7 +49,7 @@ int cameraX = 640; // Center of screen
 int cameraY = 360; // Center of screen
 float zoomLevel = 0.5f; // Zoomed out to see more
 const float ZOOM_STEP = 0.1f;
-const float MIN_ZOOM = 0.5f;
+const float MIN_ZOOM = 0.125f; // One screen pixel per texel of the coarsest atlas level
 const float MAX_ZOOM = 4.0f;
 
 // Mouse parameters
@@ -55,25 +67,102 @@ int brushSize = 3; // Diameter of brush in particles (3x3)
 const int MIN_BRUSH_SIZE = 1;
 const int MAX_BRUSH_SIZE = 20;
 
+// A cell change from the mouse, applied by the simulation thread before its
+// next tick; only the simulation thread touches the world
+struct PendingEdit {
+    int worldX;
+    int worldY;
+    uint8_t materialID;
+    bool onlyIfEmpty;   // Leave occupied cells alone
+};
+
 int main(int argc, char** argv) {
     std::cout << "Starting Dyg-Endless Sand Simulation Engine" << std::endl;
+    auto startupTime = std::chrono::high_resolution_clock::now();
     
     // Register signal handlers
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
     
+    // Command line: --software forces the CPU renderer, --dump-frames DIR
+    // writes every frame it draws. --record DIR starts recording right away
+    // (F9 toggles it), as PPM or with --record-png as PNG; --record-materials
+    // also dumps the material IDs in view. --fixed-resolution turns off
+    // dynamic resolution. --present-mode fifo|mailbox|immediate picks how
+    // frames are shown (mailbox by default, FIFO where unsupported). --fog
+    // hides what the camera center has no line of sight to.
+    // --sim-threads N updates chunks on N threads (1 = serial; all by default).
+    // --seed N generates with seed N instead of the one worlddata was
+    // pre-generated with (or the default when there is none).
+    bool useSoftwareRenderer = false;
+    unsigned int simulationThreads = 0;
+    bool fogOfWar = false;
+    bool dynamicResolution = true;
+    Engine::PresentMode presentMode = Engine::PresentMode::Mailbox;
+    std::string frameDumpDirectory;
+    std::string recordDirectory = "recordings";
+    bool recordOnStart = false;
+    Engine::CaptureFormat recordFormat = Engine::CaptureFormat::PPM;
+    bool recordMaterials = false;
+    bool seedGiven = false;
+    uint32_t seed = 12345;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--software") == 0) {
+            useSoftwareRenderer = true;
+        } else if (std::strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc) {
+            frameDumpDirectory = argv[++i];
+            useSoftwareRenderer = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordDirectory = argv[++i];
+            recordOnStart = true;
+        } else if (std::strcmp(argv[i], "--record-png") == 0) {
+            recordFormat = Engine::CaptureFormat::PNG;
+        } else if (std::strcmp(argv[i], "--record-materials") == 0) {
+            recordMaterials = true;
+        } else if (std::strcmp(argv[i], "--fog") == 0) {
+            fogOfWar = true;
+        } else if (std::strcmp(argv[i], "--sim-threads") == 0 && i + 1 < argc) {
+            simulationThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            seedGiven = true;
+        } else if (std::strcmp(argv[i], "--fixed-resolution") == 0) {
+            dynamicResolution = false;
+        } else if (std::strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (std::strcmp(mode, "fifo") == 0) {
+                presentMode = Engine::PresentMode::Fifo;
+            } else if (std::strcmp(mode, "mailbox") == 0) {
+                presentMode = Engine::PresentMode::Mailbox;
+            } else if (std::strcmp(mode, "immediate") == 0) {
+                presentMode = Engine::PresentMode::Immediate;
+            } else {
+                std::cerr << "Unknown present mode: " << mode << std::endl;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+        }
+    }
+    
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
         return 1;
     }
     
+    // Fall back to the CPU renderer on machines without Vulkan
+    if (!useSoftwareRenderer && !Engine::Renderer::isRendererAvailable(Engine::RendererType::Vulkan)) {
+        std::cout << "Vulkan is not available, using the software renderer" << std::endl;
+        useSoftwareRenderer = true;
+    }
+    Engine::RendererType rendererType = useSoftwareRenderer ? Engine::RendererType::Software : Engine::RendererType::Vulkan;
+    
     // Create SDL window
     SDL_Window* window = SDL_CreateWindow(
         WINDOW_TITLE,
         SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
         WINDOW_WIDTH, WINDOW_HEIGHT,
-        SDL_WINDOW_SHOWN | SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE
+        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | (useSoftwareRenderer ? 0u : SDL_WINDOW_VULKAN)
     );
     
     if (!window) {
@@ -93,22 +182,33 @@ int main(int argc, char** argv) {
         std::cerr << "Falling back to default materials." << std::endl;
     }
     
-    // Create a world
+    // Create a world; chunks streamed in are loaded from worlddata when saved there
     Engine::World world;
+    world.SetUpdateThreadCount(simulationThreads);
+    world.SetStreamingDirectory("worlddata");
     
-    // Create a procedural generator
-    Engine::ProceduralGenerator generator;
+    // Generate chunks that weren't pre-generated with the seed the others
+    // were, so they line up, and let them collapse on a worker before they
+    // show up. Generators keep RNG state, so each chunk gets its own.
+    if (!seedGiven) {
+        Engine::World::LoadSeed("worlddata", seed);
+    }
+    std::cout << "World seed: " << seed << std::endl;
+    world.SetChunkGenerator([seed](Engine::Chunk& chunk) {
+        Engine::ProceduralGenerator generator(seed);
+        generator.GenerateChunk(&chunk);
+    }, SETTLE_TICKS);
     
-    // Create some initial chunks around the origin
+    // Create some initial chunks around the origin; streaming adds the rest
     for (int y = -2; y <= 2; y++) {
         for (int x = -2; x <= 2; x++) {
-            Engine::Chunk* chunk = world.CreateChunk(glm::ivec2(x, y));
-            generator.GenerateChunk(chunk);
+            world.RequestChunk(glm::ivec2(x, y));
         }
     }
     
     // Create the renderer
-    auto renderer = std::make_unique<Engine::Renderer>(WINDOW_WIDTH, WINDOW_HEIGHT);
+    auto renderer = std::make_unique<Engine::Renderer>(WINDOW_WIDTH, WINDOW_HEIGHT, rendererType);
+    renderer->setPresentMode(presentMode);
     if (!renderer->initialize(window)) {
         std::cerr << "Failed to initialize renderer!" << std::endl;
         SDL_DestroyWindow(window);
@@ -116,22 +216,82 @@ int main(int argc, char** argv) {
         return 1;
     }
     
+    if (!frameDumpDirectory.empty()) {
+        renderer->setFrameDumpDirectory(frameDumpDirectory);
+    }
+    
+    // Keep GPU frames inside the frame time, with some headroom
+    renderer->setDynamicResolution(dynamicResolution, static_cast<float>(FRAME_TIME * 0.85));
+    
+    // Line of sight from the camera center, recomputed every frame
+    Engine::VisibilityMap visibility;
+    double visibilityMs = 0.0;
+    if (fogOfWar) {
+        renderer->setVisibility(&visibility);
+    }
+    
+    if (recordOnStart) {
+        renderer->startRecording(recordDirectory, recordFormat, recordMaterials);
+    }
+    
+    // The simulation runs on its own thread and publishes a snapshot of the
+    // world after every tick; the render loop draws the newest one without
+    // locking the world, so a frame costs max(sim, render) instead of both
+    Engine::WorldSnapshotPublisher publisher;
+    std::mutex editMutex;
+    std::vector<PendingEdit> pendingEdits;
+    std::atomic<bool> simulationRunning(true);
+    
+    std::thread simulationThread([&]() {
+        std::vector<PendingEdit> edits;
+        auto lastTickTime = std::chrono::high_resolution_clock::now();
+        
+        while (simulationRunning) {
+            auto tickStart = std::chrono::high_resolution_clock::now();
+            float dt = std::chrono::duration<float>(tickStart - lastTickTime).count();
+            lastTickTime = tickStart;
+            
+            {
+                std::lock_guard<std::mutex> lock(editMutex);
+                edits.swap(pendingEdits);
+            }
+            for (const PendingEdit& edit : edits) {
+                if (edit.onlyIfEmpty && !world.GetParticle(edit.worldX, edit.worldY).IsEmpty())
+                    continue;
+                world.SetParticle(edit.worldX, edit.worldY, Engine::Particle(edit.materialID));
+            }
+            edits.clear();
+            
+            world.Update(dt);
+            publisher.Publish(world);
+            
+            // Same rate cap as the render loop
+            auto tickMs = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - tickStart
+            ).count();
+            if (tickMs < FRAME_TIME) {
+                std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(FRAME_TIME - tickMs));
+            }
+        }
+    });
+    
     // Main loop
     bool quit = false;
     SDL_Event e;
     
-    auto lastFrameTime = std::chrono::high_resolution_clock::now();
+    Engine::FramePacer framePacer(FRAME_TIME);
+    bool firstFrameShown = false;
     
     // Set up a proper handler for window close button
     SDL_SetHint(SDL_HINT_VIDEO_X11_XRANDR, "1");
     SDL_SetHint(SDL_HINT_QUIT_ON_LAST_WINDOW_CLOSE, "1");
     
     while (!quit && !g_quit) {
-        // Calculate frame time and delta time
+        // Wait for the GPU, then until the frame has to start to be done on
+        // time, so the input read below is as fresh as it can be
+        renderer->waitForFrame();
+        framePacer.WaitForFrameStart();
         auto currentTime = std::chrono::high_resolution_clock::now();
-        auto frameTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            currentTime - lastFrameTime
-        ).count();
         
         // Debug message every 5 seconds
         static auto lastDebugTime = std::chrono::high_resolution_clock::now();
@@ -144,11 +304,25 @@ int main(int argc, char** argv) {
             std::cout << "         Shift+Plus/Minus to adjust brush size (current: " << brushSize << ")" << std::endl;
             std::cout << "         Keys 1-0 to select materials (current: " 
                       << Engine::MaterialDatabase::Get().GetMaterial(selectedMaterial).name << ")" << std::endl;
+            std::cout << "         M to toggle the minimap, F9 to toggle recording" << std::endl;
+            std::cout << "Render timings (ms): " << renderer->getTimingReport() << std::endl;
+            std::cout << "Frame pacing (ms): interval=" << framePacer.GetFrameInterval()
+                      << " cost=" << framePacer.GetFrameCost()
+                      << " input_latency=" << framePacer.GetInputLatency() << std::endl;
+            if (fogOfWar) {
+                std::cout << "Visibility: " << visibilityMs << " ms, "
+                          << visibility.GetVisibleChunkCount() << " chunks in sight" << std::endl;
+            }
             lastDebugTime = currentTime;
         }
         
         // Process events (check before AND after rendering)
         while (SDL_PollEvent(&e) != 0) {
+            if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP || e.type == SDL_MOUSEMOTION ||
+                e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP || e.type == SDL_MOUSEWHEEL) {
+                framePacer.AddInputEvent(static_cast<double>(SDL_GetTicks() - e.common.timestamp));
+            }
+            
             if (e.type == SDL_QUIT) {
                 std::cout << "Received SDL_QUIT event. Exiting..." << std::endl;
                 quit = true;
@@ -169,6 +343,18 @@ int main(int argc, char** argv) {
                         quit = true;
                         break;
                     
+                    case SDLK_m:
+                        renderer->setMinimapVisible(!renderer->isMinimapVisible());
+                        break;
+                    
+                    case SDLK_F9:
+                        if (renderer->isRecording()) {
+                            renderer->stopRecording();
+                        } else {
+                            renderer->startRecording(recordDirectory, recordFormat, recordMaterials);
+                        }
+                        break;
+                    
                     // Camera controls
                     case SDLK_w:
                     case SDLK_UP:
@@ -186,7 +372,7 @@ int main(int argc, char** argv) {
                     case SDLK_RIGHT:
                         cameraX += 10;
                         break;
-                        
+                    
                     // Zoom controls
                     case SDLK_EQUALS:
                     case SDLK_PLUS:
@@ -213,7 +399,7 @@ int main(int argc, char** argv) {
                             if (zoomLevel < MIN_ZOOM) zoomLevel = MIN_ZOOM;
                         }
                         break;
-                        
+                    
                     // Material selection
                     case SDLK_1:
                         selectedMaterial = 1; // Sand
@@ -328,11 +514,8 @@ int main(int argc, char** argv) {
             if (leftMousePressed) {
                 // Directly place a single particle regardless of what's there
                 std::cout << "Placing particle with material ID " << (int)selectedMaterial << std::endl;
-                world.SetParticle(worldX, worldY, Engine::Particle(selectedMaterial));
-                
-                // Check if it was placed successfully
-                const Engine::Particle& placed = world.GetParticle(worldX, worldY);
-                std::cout << "After placement: materialID=" << (int)placed.materialID << std::endl;
+                std::lock_guard<std::mutex> lock(editMutex);
+                pendingEdits.push_back({worldX, worldY, selectedMaterial, false});
             }
             
             // Old brush code with radius
@@ -351,15 +534,13 @@ int main(int argc, char** argv) {
                             int targetX = worldX + dx;
                             int targetY = worldY + dy;
                             
+                            std::lock_guard<std::mutex> lock(editMutex);
                             if (leftMousePressed) {
                                 // Place material only if the target position is empty
-                                const Engine::Particle& existingParticle = world.GetParticle(targetX, targetY);
-                                if (existingParticle.IsEmpty()) {
-                                    world.SetParticle(targetX, targetY, Engine::Particle(selectedMaterial));
-                                }
+                                pendingEdits.push_back({targetX, targetY, selectedMaterial, true});
                             } else if (rightMousePressed) {
                                 // Erase material (set to empty/air, material ID 0)
-                                world.SetParticle(targetX, targetY, Engine::Particle(0));
+                                pendingEdits.push_back({targetX, targetY, 0, false});
                             }
                         }
                     }
@@ -372,19 +553,41 @@ int main(int argc, char** argv) {
             break;
         }
         
-        // Update simulation (based on delta time)
-        float dt = frameTimeMs / 1000.0f; // Convert to seconds
-        world.Update(dt);
+        // Pick up the newest simulation tick, if there is one
+        publisher.AcquireLatest();
+        
+        // Sight reaches the edges of the screen
+        if (fogOfWar) {
+            int windowWidth = WINDOW_WIDTH;
+            int windowHeight = WINDOW_HEIGHT;
+            SDL_GetWindowSize(window, &windowWidth, &windowHeight);
+            const int radius = static_cast<int>(std::max(windowWidth, windowHeight) / 2 / zoomLevel) + 1;
+            
+            auto visibilityStart = std::chrono::high_resolution_clock::now();
+            visibility.Compute(publisher.GetLatest(), glm::ivec2(cameraX, cameraY), radius);
+            visibilityMs = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - visibilityStart
+            ).count();
+        }
         
         // Render
         try {
             renderer->beginFrame();
-            renderer->renderWorld(world, cameraX, cameraY, zoomLevel);
+            renderer->renderWorld(publisher.GetLatest(), cameraX, cameraY, zoomLevel);
             renderer->endFrame();
+            
+            // Startup cost, e.g. to compare cold and warm pipeline caches
+            if (!firstFrameShown) {
+                firstFrameShown = true;
+                std::cout << "First frame after " << std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - startupTime
+                ).count() << " ms" << std::endl;
+            }
         } catch (const std::exception& e) {
             std::cerr << "Rendering error: " << e.what() << std::endl;
             // Don't quit on rendering errors, just skip this frame
         }
+        framePacer.EndFrame();
         
         // Process events again after rendering
         SDL_PumpEvents(); // Update the event queue
@@ -392,18 +595,11 @@ int main(int argc, char** argv) {
             std::cout << "Quit event detected after rendering" << std::endl;
             quit = true;
         }
-        
-        // Cap frame rate if frame time less than target
-        if (frameTimeMs < FRAME_TIME) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(
-                static_cast<int>(FRAME_TIME - frameTimeMs)
-            ));
-        }
-        
-        lastFrameTime = currentTime;
     }
     
-    // Save the world before exiting
+    // Let the simulation finish its tick, then save the world before exiting
+    simulationRunning = false;
+    simulationThread.join();
     world.Save("worlddata");
     
     // Cleanup